@@ -0,0 +1,1216 @@
+#include "vector.h"
+#include "concurrent_vector.h"
+#include "simd_algorithms.h"
+#include "parallel_algorithms.h"
+#include "mapped_vector.h"
+#include "serialization.h"
+#include "small_vector.h"
+#include "soa_vector.h"
+#include "cow_vector.h"
+#include "test_types.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Тот же int64_t, но с пользовательскими конструкторами и деструктором:
+// Vector переносит такой тип общим путём, поэлементно, с циклом деструкторов
+struct GenericInt64 {
+    GenericInt64() = default;
+    GenericInt64(const GenericInt64& other) noexcept
+        : value(other.value) {}
+    GenericInt64(GenericInt64&& other) noexcept
+        : value(other.value) {}
+    GenericInt64& operator=(const GenericInt64& other) = default;
+    GenericInt64& operator=(GenericInt64&& other) = default;
+    ~GenericInt64() {}
+
+    int64_t value = 0;
+};
+
+// Тот же GenericInt64, объявленный побайтно перемещаемым: перенос снова один memcpy, без деструкторов
+struct RelocatableInt64 : GenericInt64 {};
+
+}  // namespace
+
+template <>
+struct IsTriviallyRelocatable<RelocatableInt64> : std::true_type {};
+
+namespace {
+
+// Сколько раз повторить замер, чтобы маленькие размеры не тонули в погрешности таймера
+size_t Repetitions(size_t size, size_t work = 10'000'000) {
+    return size >= work ? 1 : work / size;
+}
+
+void Report(std::string_view bench, std::string_view type, size_t size, std::chrono::nanoseconds total, size_t reps) {
+    const double ns_per_elem = static_cast<double>(total.count()) / static_cast<double>(reps * size);
+    std::cout << bench << '\t' << type << '\t' << size << '\t' << ns_per_elem << '\n';
+}
+
+// Не даёт компилятору выбросить результат замера как неиспользуемый
+template <typename T>
+void DoNotOptimize(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// POD размером в четыре кэш-линии: перенос упирается в пропускную способность памяти
+struct LargePod {
+    int64_t words[32] = {};
+};
+
+// Образец элемента для PushBack/Emplace. Строка короткая (SSO),
+// чтобы объём памяти зависел только от sizeof и размеры можно было ограничить заранее
+template <typename T>
+T Sample() {
+    return T{};
+}
+
+template <>
+int Sample<int>() {
+    return 42;
+}
+
+template <>
+std::string Sample<std::string>() {
+    return "benchmark";
+}
+
+template <>
+Obj Sample<Obj>() {
+    return Obj(42, "benchmark");
+}
+
+// Единый интерфейс к Vector и std::vector, чтобы гонять на них одни и те же замеры
+template <typename Container>
+struct Ops;
+
+template <typename T>
+struct Ops<Vector<T>> {
+    static constexpr std::string_view NAME = "Vector";
+
+    static void PushBack(Vector<T>& v, const T& value) {
+        v.PushBack(value);
+    }
+    static void EmplaceBack(Vector<T>& v) {
+        v.EmplaceBack();
+    }
+    static void Reserve(Vector<T>& v, size_t capacity) {
+        v.Reserve(capacity);
+    }
+    static void Resize(Vector<T>& v, size_t size) {
+        v.Resize(size);
+    }
+    static void EmplaceAt(Vector<T>& v, size_t index, const T& value) {
+        v.Emplace(v.begin() + index, value);
+    }
+    static void EraseAt(Vector<T>& v, size_t index) {
+        v.Erase(v.begin() + index);
+    }
+    static size_t Size(const Vector<T>& v) {
+        return v.Size();
+    }
+};
+
+template <typename T>
+struct Ops<std::vector<T>> {
+    static constexpr std::string_view NAME = "std::vector";
+
+    static void PushBack(std::vector<T>& v, const T& value) {
+        v.push_back(value);
+    }
+    static void EmplaceBack(std::vector<T>& v) {
+        v.emplace_back();
+    }
+    static void Reserve(std::vector<T>& v, size_t capacity) {
+        v.reserve(capacity);
+    }
+    static void Resize(std::vector<T>& v, size_t size) {
+        v.resize(size);
+    }
+    static void EmplaceAt(std::vector<T>& v, size_t index, const T& value) {
+        v.emplace(v.begin() + index, value);
+    }
+    static void EraseAt(std::vector<T>& v, size_t index) {
+        v.erase(v.begin() + index);
+    }
+    static size_t Size(const std::vector<T>& v) {
+        return v.size();
+    }
+};
+
+// Одна строка результата. unit — во что пересчитано время: "elem" для массовых операций
+// (на элемент вектора), "op" для одиночных вызовов (на вызов)
+void ReportOp(std::string_view bench, std::string_view impl, std::string_view type, size_t size,
+              std::string_view unit, std::chrono::nanoseconds total, size_t count) {
+    std::cout << bench << '\t' << impl << '\t' << type << '\t' << size << '\t' << unit << '\t'
+              << static_cast<double>(total.count()) / static_cast<double>(std::max<size_t>(count, 1)) << '\n';
+}
+
+// Позиция одиночной вставки/удаления
+enum class Position {
+    FRONT,
+    MIDDLE,
+    BACK,
+};
+
+// Работа одного замера массовой операции (в элементах), чтобы малые размеры повторялись чаще
+const size_t OPERATIONS_WORK = 2'000'000;
+// Сколько одиночных Emplace/Erase делать на одном векторе
+const size_t MAX_SINGLE_OPS = 1'000;
+
+template <typename Container>
+void MeasureSingleOps(std::string_view type, size_t size, Position position, std::string_view emplace_name,
+                      std::string_view erase_name) {
+    using Clock = std::chrono::steady_clock;
+    using ContainerOps = Ops<Container>;
+    using T = typename Container::value_type;
+    const T sample = Sample<T>();
+    const size_t ops = std::clamp<size_t>(OPERATIONS_WORK / size, 1, MAX_SINGLE_OPS);
+
+    Container v;
+    ContainerOps::Reserve(v, size + ops);
+    ContainerOps::Resize(v, size);
+    auto index = [&](bool erase) {
+        const size_t current = ContainerOps::Size(v);
+        switch (position) {
+            case Position::FRONT:
+                return size_t{0};
+            case Position::MIDDLE:
+                return current / 2;
+            case Position::BACK:
+                break;
+        }
+        return erase ? current - 1 : current;
+    };
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < ops; ++i) {
+        ContainerOps::EmplaceAt(v, index(false), sample);
+    }
+    auto elapsed = Clock::now() - start;
+    DoNotOptimize(v);
+    ReportOp(emplace_name, ContainerOps::NAME, type, size, "op",
+             std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed), ops);
+
+    start = Clock::now();
+    for (size_t i = 0; i < ops; ++i) {
+        ContainerOps::EraseAt(v, index(true));
+    }
+    elapsed = Clock::now() - start;
+    DoNotOptimize(v);
+    ReportOp(erase_name, ContainerOps::NAME, type, size, "op",
+             std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed), ops);
+}
+
+// Все операции над контейнером одного типа и размера
+template <typename Container>
+void MeasureOperations(std::string_view type, size_t size) {
+    using Clock = std::chrono::steady_clock;
+    using std::chrono::duration_cast;
+    using std::chrono::nanoseconds;
+    using ContainerOps = Ops<Container>;
+    using T = typename Container::value_type;
+    const T sample = Sample<T>();
+    const size_t reps = Repetitions(size, OPERATIONS_WORK);
+
+    Clock::duration push_back{};
+    Clock::duration emplace_back{};
+    Clock::duration reserve{};
+    Clock::duration resize{};
+    for (size_t rep = 0; rep < reps; ++rep) {
+        {
+            Container v;
+            const auto start = Clock::now();
+            for (size_t i = 0; i < size; ++i) {
+                ContainerOps::PushBack(v, sample);
+            }
+            push_back += Clock::now() - start;
+            DoNotOptimize(v);
+        }
+        {
+            Container v;
+            const auto start = Clock::now();
+            for (size_t i = 0; i < size; ++i) {
+                ContainerOps::EmplaceBack(v);
+            }
+            emplace_back += Clock::now() - start;
+            DoNotOptimize(v);
+        }
+        {
+            Container v;
+            auto start = Clock::now();
+            ContainerOps::Resize(v, size);
+            resize += Clock::now() - start;
+            start = Clock::now();
+            ContainerOps::Reserve(v, size * 2);
+            reserve += Clock::now() - start;
+            DoNotOptimize(v);
+        }
+    }
+    ReportOp("push_back", ContainerOps::NAME, type, size, "elem", duration_cast<nanoseconds>(push_back), reps * size);
+    ReportOp("emplace_back", ContainerOps::NAME, type, size, "elem", duration_cast<nanoseconds>(emplace_back),
+             reps * size);
+    ReportOp("resize", ContainerOps::NAME, type, size, "elem", duration_cast<nanoseconds>(resize), reps * size);
+    ReportOp("reserve", ContainerOps::NAME, type, size, "elem", duration_cast<nanoseconds>(reserve), reps * size);
+
+    Clock::duration copy_assign{};
+    Clock::duration move_assign{};
+    {
+        Container src;
+        Container dst;
+        for (size_t i = 0; i < size; ++i) {
+            ContainerOps::PushBack(src, sample);
+            ContainerOps::PushBack(dst, sample);
+        }
+        for (size_t rep = 0; rep < reps; ++rep) {
+            const auto start = Clock::now();
+            dst = src;
+            copy_assign += Clock::now() - start;
+            DoNotOptimize(dst);
+        }
+        // Перемещение не зависит от размера, поэтому повторяем его столько же раз, сколько копирование
+        // перебрало элементов. Буфер гоняется туда и обратно, так что перемещений вдвое больше
+        const auto start = Clock::now();
+        for (size_t rep = 0; rep < reps * size; ++rep) {
+            dst = std::move(src);
+            src = std::move(dst);
+            DoNotOptimize(src);
+        }
+        move_assign = Clock::now() - start;
+    }
+    ReportOp("copy_assign", ContainerOps::NAME, type, size, "elem", duration_cast<nanoseconds>(copy_assign),
+             reps * size);
+    ReportOp("move_assign", ContainerOps::NAME, type, size, "op", duration_cast<nanoseconds>(move_assign),
+             2 * reps * size);
+
+    MeasureSingleOps<Container>(type, size, Position::FRONT, "emplace_front", "erase_front");
+    MeasureSingleOps<Container>(type, size, Position::MIDDLE, "emplace_middle", "erase_middle");
+    MeasureSingleOps<Container>(type, size, Position::BACK, "emplace_back_pos", "erase_back");
+}
+
+// Сколько памяти разрешено занять одному вектору: большие типы гоняем на меньших размерах
+const size_t MAX_VECTOR_BYTES = 512 * 1024 * 1024;
+
+template <typename T>
+void BenchmarkOperationsForType(std::string_view type, size_t max_size) {
+    const size_t limit = std::min(max_size, MAX_VECTOR_BYTES / sizeof(T));
+    for (size_t size = 1; size <= limit; size *= 10) {
+        MeasureOperations<Vector<T>>(type, size);
+        MeasureOperations<std::vector<T>>(type, size);
+    }
+}
+
+// Vector против std::vector на основных операциях.
+// Формат: TSV с заголовком, одна строка на (операцию, реализацию, тип, размер)
+void BenchmarkOperations(size_t max_size) {
+    std::cout << "bench\timpl\ttype\tsize\tunit\tns\n";
+    BenchmarkOperationsForType<int>("int", max_size);
+    BenchmarkOperationsForType<std::string>("string", max_size);
+    BenchmarkOperationsForType<C>("C", max_size);
+    BenchmarkOperationsForType<Obj>("Obj", max_size);
+    BenchmarkOperationsForType<LargePod>("large_pod", max_size);
+}
+
+template <typename T>
+void BenchmarkReserve(std::string_view type, size_t size) {
+    using Clock = std::chrono::steady_clock;
+    const size_t reps = Repetitions(size);
+    Clock::duration total{};
+    for (size_t i = 0; i < reps; ++i) {
+        Vector<T> v(size);
+        const auto start = Clock::now();
+        v.Reserve(size * 2);
+        total += Clock::now() - start;
+    }
+    Report("reserve", type, size, std::chrono::duration_cast<std::chrono::nanoseconds>(total), reps);
+}
+
+template <typename T>
+void BenchmarkCopy(std::string_view type, size_t size) {
+    using Clock = std::chrono::steady_clock;
+    const size_t reps = Repetitions(size);
+    const Vector<T> v(size);
+    Clock::duration total{};
+    for (size_t i = 0; i < reps; ++i) {
+        const auto start = Clock::now();
+        Vector<T> v_copy(v);
+        total += Clock::now() - start;
+    }
+    Report("copy", type, size, std::chrono::duration_cast<std::chrono::nanoseconds>(total), reps);
+}
+
+template <typename T>
+void BenchmarkPushBack(std::string_view type, size_t size) {
+    using Clock = std::chrono::steady_clock;
+    const size_t reps = Repetitions(size);
+    Clock::duration total{};
+    for (size_t i = 0; i < reps; ++i) {
+        const auto start = Clock::now();
+        Vector<T> v;
+        for (size_t j = 0; j < size; ++j) {
+            v.EmplaceBack();
+        }
+        total += Clock::now() - start;
+    }
+    Report("push_back", type, size, std::chrono::duration_cast<std::chrono::nanoseconds>(total), reps);
+}
+
+void BenchmarkRelocation(size_t max_size) {
+    std::cout << "bench\ttype\tsize\tns_per_elem\n";
+    for (size_t size = 1'000; size <= max_size; size *= 10) {
+        BenchmarkReserve<int64_t>("int64_t", size);
+        BenchmarkReserve<GenericInt64>("generic_int64", size);
+        BenchmarkReserve<RelocatableInt64>("relocatable_int64", size);
+        BenchmarkReserve<std::unique_ptr<int64_t>>("unique_ptr", size);
+        BenchmarkCopy<int64_t>("int64_t", size);
+        BenchmarkCopy<GenericInt64>("generic_int64", size);
+        BenchmarkPushBack<int64_t>("int64_t", size);
+        BenchmarkPushBack<GenericInt64>("generic_int64", size);
+        BenchmarkPushBack<RelocatableInt64>("relocatable_int64", size);
+        BenchmarkPushBack<std::unique_ptr<int64_t>>("unique_ptr", size);
+    }
+}
+
+// Одиночные вставки и удаления в начале и середине вектора без реаллокации: время уходит на сдвиг хвоста.
+// Для побайтно перемещаемых типов Vector сдвигает его одним memmove, для GenericInt64 — поэлементно
+template <typename T>
+void BenchmarkShiftForType(std::string_view type, size_t max_size) {
+    for (size_t size = 1'000; size <= std::min<size_t>(max_size, 1'000'000); size *= 10) {
+        MeasureSingleOps<Vector<T>>(type, size, Position::FRONT, "emplace_front", "erase_front");
+        MeasureSingleOps<std::vector<T>>(type, size, Position::FRONT, "emplace_front", "erase_front");
+        MeasureSingleOps<Vector<T>>(type, size, Position::MIDDLE, "emplace_middle", "erase_middle");
+        MeasureSingleOps<std::vector<T>>(type, size, Position::MIDDLE, "emplace_middle", "erase_middle");
+    }
+}
+
+void BenchmarkShift(size_t max_size) {
+    std::cout << "bench\timpl\ttype\tsize\tunit\tns\n";
+    BenchmarkShiftForType<int64_t>("int64_t", max_size);
+    BenchmarkShiftForType<GenericInt64>("generic_int64", max_size);
+    BenchmarkShiftForType<RelocatableInt64>("relocatable_int64", max_size);
+    BenchmarkShiftForType<std::shared_ptr<int64_t>>("shared_ptr", max_size);
+}
+
+#ifdef __linux__
+// Растит вектор PushBack'ами до size элементов и печатает время одной реаллокации
+// (среднее и худшее) и пиковый RSS процесса
+template <typename Allocator>
+void MeasureGrowth(std::string_view allocator, size_t size) {
+    using Clock = std::chrono::steady_clock;
+    Vector<uint32_t, Allocator> v;
+    size_t growths = 0;
+    Clock::duration total{};
+    Clock::duration worst{};
+    for (size_t i = 0; i < size; ++i) {
+        const size_t capacity = v.Capacity();
+        const auto start = Clock::now();
+        v.PushBack(static_cast<uint32_t>(i));
+        const auto elapsed = Clock::now() - start;
+        if (v.Capacity() != capacity) {
+            ++growths;
+            total += elapsed;
+            worst = std::max(worst, elapsed);
+        }
+    }
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    std::cout << "growth\t" << allocator << '\t' << size << '\t' << growths << '\t'
+              << duration_cast<microseconds>(total).count() / static_cast<double>(growths) << '\t'
+              << duration_cast<microseconds>(worst).count() << '\t'
+              << usage.ru_maxrss << std::endl;
+}
+
+// Каждый замер идёт в отдельном процессе, иначе пиковый RSS достался бы от предыдущего
+template <typename Allocator>
+void MeasureGrowthInChild(std::string_view allocator, size_t size) {
+    std::cout.flush();
+    const pid_t pid = fork();
+    if (pid == 0) {
+        MeasureGrowth<Allocator>(allocator, size);
+        _exit(0);
+    }
+    if (pid > 0) {
+        waitpid(pid, nullptr, 0);
+    }
+}
+
+void BenchmarkGrowth(size_t max_size) {
+    std::cout << "bench\tallocator\tsize\tgrowths\tavg_growth_us\tmax_growth_us\tpeak_rss_kb\n";
+    for (size_t size = 1'000'000; size <= max_size; size *= 10) {
+        MeasureGrowthInChild<std::allocator<uint32_t>>("std_allocator", size);
+        MeasureGrowthInChild<ReallocAllocator<uint32_t>>("realloc_allocator", size);
+    }
+}
+#else
+void BenchmarkGrowth(size_t /*max_size*/) {
+}
+#endif
+
+// Первое касание: сколько стоит создать (и тем самым обнулить) вектор из size элементов.
+// Случайный доступ: средняя стоимость чтения по псевдослучайному индексу
+template <typename Allocator>
+void MeasureRandomAccess(std::string_view mode, size_t size, const Allocator& alloc) {
+    using Clock = std::chrono::steady_clock;
+    using std::chrono::duration_cast;
+    using std::chrono::nanoseconds;
+
+    const auto alloc_start = Clock::now();
+    Vector<uint64_t, Allocator> v(size, alloc);
+    const auto first_touch = Clock::now() - alloc_start;
+    for (size_t i = 0; i < size; ++i) {
+        v[i] = i;
+    }
+
+    const size_t accesses = 20'000'000;
+    uint64_t state = 88172645463325252ull;
+    uint64_t sum = 0;
+    const auto start = Clock::now();
+    for (size_t i = 0; i < accesses; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        sum += v[state % size];
+    }
+    const auto random_access = Clock::now() - start;
+
+    std::cout << "huge_pages\t" << mode << '\t' << size << '\t'
+              << duration_cast<nanoseconds>(first_touch).count() / static_cast<double>(size) << '\t'
+              << duration_cast<nanoseconds>(random_access).count() / static_cast<double>(accesses) << '\t'
+              << (sum & 1) << '\n';
+}
+
+void BenchmarkHugePages(size_t max_size) {
+    std::cout << "bench\tmode\tsize\tfirst_touch_ns_per_elem\trandom_access_ns\tchecksum\n";
+    HugePageOptions huge;
+    HugePageOptions prefaulted;
+    prefaulted.prefault = true;
+    for (size_t size = 1 << 20; size <= max_size; size *= 8) {
+        MeasureRandomAccess("heap", size, std::allocator<uint64_t>());
+        MeasureRandomAccess("huge_pages", size, HugePageAllocator<uint64_t>(huge));
+        MeasureRandomAccess("huge_pages_prefault", size, HugePageAllocator<uint64_t>(prefaulted));
+    }
+}
+
+// Буфер, нарочно сдвинутый на Offset байт от границы кэш-линии: худший случай для векторных загрузок
+template <typename T, size_t Offset = sizeof(T)>
+struct MisalignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = MisalignedAllocator<U, Offset>;
+    };
+
+    MisalignedAllocator() noexcept = default;
+
+    template <typename U>
+    MisalignedAllocator(const MisalignedAllocator<U, Offset>& /*other*/) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        auto* base = static_cast<char*>(operator new(n * sizeof(T) + 64, std::align_val_t{64}));
+        return reinterpret_cast<T*>(base + Offset);
+    }
+
+    void deallocate(T* buf, size_t /*n*/) noexcept {
+        operator delete(reinterpret_cast<char*>(buf) - Offset, std::align_val_t{64});
+    }
+
+    bool operator==(const MisalignedAllocator& /*other*/) const noexcept {
+        return true;
+    }
+
+    bool operator!=(const MisalignedAllocator& /*other*/) const noexcept {
+        return false;
+    }
+};
+
+// Потоковый цикл y = a * x + y по двум векторам
+template <typename Allocator>
+void MeasureSaxpy(std::string_view alignment, size_t size) {
+    using Clock = std::chrono::steady_clock;
+    Vector<float, Allocator> x(size);
+    Vector<float, Allocator> y(size);
+    for (size_t i = 0; i < size; ++i) {
+        x[i] = static_cast<float>(i % 7);
+        y[i] = static_cast<float>(i % 5);
+    }
+    const float a = 1.0001f;
+    const size_t reps = std::max<size_t>(1, 200'000'000 / size);
+    float* __restrict y_data = &y[0];
+    const float* __restrict x_data = &x[0];
+    const auto start = Clock::now();
+    for (size_t rep = 0; rep < reps; ++rep) {
+        for (size_t i = 0; i < size; ++i) {
+            y_data[i] = a * x_data[i] + y_data[i];
+        }
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+    std::cout << "saxpy\t" << alignment << '\t' << size << '\t'
+              << static_cast<double>(elapsed.count()) / static_cast<double>(reps * size) << '\t'
+              << y[size / 2] << '\n';
+}
+
+void BenchmarkAlignment(size_t max_size) {
+    std::cout << "bench\talignment\tsize\tns_per_elem\tchecksum\n";
+    for (size_t size = 1'000; size <= std::min<size_t>(max_size, 10'000'000); size *= 10) {
+        MeasureSaxpy<AlignedAllocator<float, 64>>("cache_line", size);
+        MeasureSaxpy<MisalignedAllocator<float>>("misaligned", size);
+    }
+}
+
+// Vector под мьютексом: так писатели сериализуются без ConcurrentVector
+class LockedVector {
+public:
+    void PushBack(uint64_t value) {
+        std::lock_guard guard(mutex_);
+        data_.PushBack(value);
+    }
+
+    size_t Size() const {
+        std::lock_guard guard(mutex_);
+        return data_.Size();
+    }
+
+private:
+    mutable std::mutex mutex_;
+    Vector<uint64_t> data_;
+};
+
+// threads потоков вместе дописывают size элементов; время — от старта первого до конца последнего
+template <typename Container>
+void MeasureConcurrentAppend(std::string_view impl, size_t threads, size_t size) {
+    using Clock = std::chrono::steady_clock;
+    Container v;
+    const size_t per_thread = size / threads;
+    std::vector<std::thread> writers;
+    const auto start = Clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        writers.emplace_back([&v, t, per_thread] {
+            for (size_t i = 0; i < per_thread; ++i) {
+                v.PushBack(static_cast<uint64_t>(t * per_thread + i));
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+    const size_t total = per_thread * threads;
+    std::cout << "concurrent_append\t" << impl << '\t' << threads << '\t' << total << '\t'
+              << static_cast<double>(elapsed.count()) / static_cast<double>(total) << '\t' << v.Size() << '\n';
+}
+
+void BenchmarkConcurrentAppend(size_t max_size) {
+    std::cout << "bench\timpl\tthreads\tsize\tns_per_elem\tchecksum\n";
+    const size_t size = std::min<size_t>(max_size, 10'000'000);
+    const size_t max_threads = std::max<size_t>(std::thread::hardware_concurrency(), 2);
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        MeasureConcurrentAppend<LockedVector>("mutex_vector", threads, size);
+        MeasureConcurrentAppend<ConcurrentVector<uint64_t>>("concurrent_vector", threads, size);
+    }
+}
+
+// Время одного прохода func по вектору из size элементов, в наносекундах на элемент
+template <typename Func>
+void MeasureScan(std::string_view bench, std::string_view impl, std::string_view type, size_t size, Func func) {
+    using Clock = std::chrono::steady_clock;
+    const size_t reps = Repetitions(size, 100'000'000);
+    const auto start = Clock::now();
+    for (size_t rep = 0; rep < reps; ++rep) {
+        DoNotOptimize(func());
+    }
+    ReportOp(bench, impl, type, size, "elem", Clock::now() - start, reps * size);
+}
+
+// Каждая операция: сначала алгоритм STL как точка отсчёта, затем simd_algorithms.h на каждом уровне,
+// который есть у процессора. Искомое значение в векторе отсутствует, так что Find проходит его целиком
+template <typename T>
+void MeasureSimdAlgorithms(std::string_view type, size_t size) {
+    Vector<T> v(size);
+    for (size_t i = 0; i < size; ++i) {
+        v[i] = static_cast<T>(static_cast<int>(i % 1000) - 500);
+    }
+    const T absent = static_cast<T>(1'000'000);
+    const T threshold = static_cast<T>(0);
+    Vector<T> out;
+    out.Reserve(size);
+
+    const T* first = v.begin();
+    const T* last = v.end();
+    MeasureScan("find", "std", type, size, [&] {
+        return std::find(first, last, absent);
+    });
+    MeasureScan("count", "std", type, size, [&] {
+        return std::count(first, last, threshold);
+    });
+    MeasureScan("sum", "std", type, size, [&] {
+        return std::accumulate(first, last, detail::simd::SumType<T>{0});
+    });
+    MeasureScan("min_max", "std", type, size, [&] {
+        return std::minmax_element(first, last);
+    });
+    std::vector<T> std_out;
+    std_out.reserve(size);
+    MeasureScan("filter", "std", type, size, [&] {
+        std_out.clear();
+        std::copy_if(first, last, std::back_inserter(std_out), [&](T x) {
+            return x < threshold;
+        });
+        return std_out.size();
+    });
+
+    const std::pair<SimdLevel, std::string_view> levels[] = {
+        {SimdLevel::SCALAR, "scalar"}, {SimdLevel::SSE2, "sse2"}, {SimdLevel::AVX2, "avx2"}, {SimdLevel::AVX512, "avx512"}};
+    for (const auto& [level, impl] : levels) {
+        if (SetSimdLevel(level) != level) {
+            continue;
+        }
+        MeasureScan("find", impl, type, size, [&] {
+            return Find(v, absent);
+        });
+        MeasureScan("count", impl, type, size, [&] {
+            return Count(v, threshold);
+        });
+        MeasureScan("sum", impl, type, size, [&] {
+            return Sum(v);
+        });
+        MeasureScan("min_max", impl, type, size, [&] {
+            return MinMax(v);
+        });
+        MeasureScan("filter", impl, type, size, [&] {
+            out.Clear();
+            return Filter(v, CompareOp::LESS, threshold, out);
+        });
+    }
+    SetSimdLevel(SimdLevel::AVX512);
+}
+
+// Векторизованные поиск и свёртки против алгоритмов STL, от размеров в L1 до основной памяти
+void BenchmarkSimd(size_t max_size) {
+    std::cout << "bench\timpl\ttype\tsize\tunit\tns\n";
+    for (size_t size = 1'000; size <= std::min<size_t>(max_size, 10'000'000); size *= 10) {
+        MeasureSimdAlgorithms<int32_t>("int32", size);
+        MeasureSimdAlgorithms<float>("float", size);
+    }
+}
+
+// Пропускная способность одной операции: миллионов элементов в секунду
+template <typename Func>
+void MeasureParallel(std::string_view bench, size_t threads, size_t size, Func func) {
+    using Clock = std::chrono::steady_clock;
+    const size_t reps = Repetitions(size, 50'000'000);
+    Clock::duration total{};
+    for (size_t rep = 0; rep < reps; ++rep) {
+        total += func();
+    }
+    const double seconds = std::chrono::duration<double>(total).count();
+    std::cout << bench << '\t' << threads << '\t' << size << '\t'
+              << static_cast<double>(reps * size) / seconds / 1e6 << '\n';
+}
+
+template <typename Func>
+std::chrono::steady_clock::duration Timed(Func func) {
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::steady_clock::now() - start;
+}
+
+// Пул из threads - 1 рабочих: вызывающий поток берёт свою долю блоков сам
+void MeasureParallelAlgorithms(size_t threads, size_t size) {
+    ThreadPool pool(threads - 1);
+    Vector<double> v(size);
+    Vector<double> out(size);
+    auto fill = [&] {
+        uint64_t state = 42;
+        for (double& x : v) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            x = static_cast<double>(state >> 11) * 0x1.0p-53;
+        }
+    };
+    fill();
+    MeasureParallel("for_each", threads, size, [&] {
+        return Timed([&] {
+            ForEach(pool, v, [](double& x) {
+                x = x * 0.5 + 0.25;
+            });
+        });
+    });
+    MeasureParallel("transform", threads, size, [&] {
+        return Timed([&] {
+            Transform(pool, v, out, [](double x) {
+                return std::sqrt(x) * 3.0;
+            });
+        });
+    });
+    MeasureParallel("reduce", threads, size, [&] {
+        double sum = 0;
+        const auto elapsed = Timed([&] {
+            sum = Reduce(pool, v, 0.0);
+        });
+        DoNotOptimize(sum);
+        return elapsed;
+    });
+    MeasureParallel("inclusive_scan", threads, size, [&] {
+        return Timed([&] {
+            InclusiveScan(pool, v, out);
+        });
+    });
+    MeasureParallel("sort", threads, size, [&] {
+        fill();
+        return Timed([&] {
+            Sort(pool, v);
+        });
+    });
+}
+
+// Масштабирование параллельных алгоритмов: пропускная способность на 1, 2, 4, ... потоках
+void BenchmarkParallel(size_t max_size) {
+    std::cout << "bench\tthreads\tsize\tmelem_per_s\n";
+    const size_t size = std::min<size_t>(max_size, 10'000'000);
+    const size_t max_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    for (size_t threads = 1; threads < max_threads * 2; threads *= 2) {
+        MeasureParallelAlgorithms(std::min(threads, max_threads), size);
+    }
+}
+
+// Запись таблицы, которую загружают при старте
+struct TableRecord {
+    int64_t key;
+    int64_t payload[3];
+};
+
+// Время загрузки таблицы из файла в миллисекундах: поэлементное чтение с PushBack,
+// чтение одним куском и открытие MappedVector (само по себе и с проходом по всем элементам)
+void MeasureTableLoad(const std::string& path, size_t size) {
+    using Clock = std::chrono::steady_clock;
+    auto report = [&](std::string_view bench, Clock::time_point start, int64_t checksum) {
+        std::cout << bench << '\t' << size << '\t'
+                  << std::chrono::duration<double, std::milli>(Clock::now() - start).count() << '\t' << checksum
+                  << '\n';
+    };
+    std::filesystem::remove(path);
+    {
+        MappedVector<TableRecord> table(path, MapMode::READ_WRITE);
+        table.Reserve(size);
+        for (size_t i = 0; i < size; ++i) {
+            table.PushBack(TableRecord{static_cast<int64_t>(i), {1, 2, 3}});
+        }
+        table.Flush();
+    }
+    const long offset = static_cast<long>(MappedVector<TableRecord>::DATA_OFFSET);
+    {
+        const auto start = Clock::now();
+        Vector<TableRecord> table;
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        std::fseek(file, offset, SEEK_SET);
+        TableRecord record;
+        for (size_t i = 0; i < size && std::fread(&record, sizeof(record), 1, file) == 1; ++i) {
+            table.PushBack(record);
+        }
+        std::fclose(file);
+        report("read_push_back", start, table[size - 1].key);
+    }
+    {
+        const auto start = Clock::now();
+        Vector<TableRecord> table;
+        table.ResizeUninitialized(size);
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        std::fseek(file, offset, SEEK_SET);
+        const size_t read = std::fread(table.begin(), sizeof(TableRecord), size, file);
+        std::fclose(file);
+        report("read_bulk", start, static_cast<int64_t>(read) + table[size - 1].key);
+    }
+    {
+        const auto start = Clock::now();
+        const MappedVector<TableRecord> table(path);
+        report("mmap_open", start, table[size - 1].key);
+    }
+    {
+        const auto start = Clock::now();
+        const MappedVector<TableRecord> table(path);
+        int64_t sum = 0;
+        for (const TableRecord& record : table) {
+            sum += record.key;
+        }
+        report("mmap_open_scan", start, sum);
+    }
+    std::filesystem::remove(path);
+}
+
+// Загрузка таблицы при старте: Vector из файла против MappedVector.
+// Файл только что записан и лежит в page cache, так что замер показывает работу процессора, а не диска
+void BenchmarkMapped(size_t max_size) {
+    std::cout << "bench\tsize\tms\tchecksum\n";
+    const std::string path = (std::filesystem::temp_directory_path() / "mapped_vector_benchmark.bin").string();
+    for (size_t size = 1'000; size <= std::min<size_t>(max_size, 10'000'000); size *= 10) {
+        MeasureTableLoad(path, size);
+    }
+}
+
+// Сохранение и загрузка через файл: по элементу в цикле, как раньше, и через Save/Load.
+// Поэлементный цикл пользуется теми же кодеками, так что разница — только в пакетной передаче
+template <typename T>
+void MeasureSerialization(std::string_view type, const std::string& path, const Vector<T>& v) {
+    using Clock = std::chrono::steady_clock;
+    const size_t size = v.Size();
+    auto report = [&](std::string_view bench, std::string_view impl, Clock::time_point start) {
+        ReportOp(bench, impl, type, size, "elem", Clock::now() - start, size);
+    };
+    {
+        const auto start = Clock::now();
+        std::ofstream out(path, std::ios::binary);
+        detail::serialization::StreamWriter writer(out);
+        const uint64_t count = size;
+        writer.Write(&count, sizeof(count));
+        for (const T& value : v) {
+            Codec<T>::Encode(value, writer);
+        }
+        out.close();
+        report("save", "per_element", start);
+    }
+    {
+        const auto start = Clock::now();
+        std::ifstream in(path, std::ios::binary);
+        detail::serialization::StreamReader reader(in);
+        uint64_t count = 0;
+        reader.Read(&count, sizeof(count));
+        Vector<T> loaded;
+        for (uint64_t i = 0; i < count; ++i) {
+            loaded.PushBack(Codec<T>::Decode(reader));
+        }
+        report("load", "per_element", start);
+        DoNotOptimize(loaded);
+    }
+    {
+        const auto start = Clock::now();
+        std::ofstream out(path, std::ios::binary);
+        Save(v, out);
+        out.close();
+        report("save", "save_load", start);
+    }
+    {
+        const auto start = Clock::now();
+        std::ifstream in(path, std::ios::binary);
+        Vector<T> loaded;
+        Load(loaded, in);
+        report("load", "save_load", start);
+        DoNotOptimize(loaded);
+    }
+    std::filesystem::remove(path);
+}
+
+void BenchmarkSerialization(size_t max_size) {
+    std::cout << "bench\timpl\ttype\tsize\tunit\tns\n";
+    const std::string path = (std::filesystem::temp_directory_path() / "vector_serialization_benchmark.bin").string();
+    for (size_t size = 1'000; size <= std::min<size_t>(max_size, 10'000'000); size *= 10) {
+        Vector<int64_t> numbers(size);
+        std::iota(numbers.begin(), numbers.end(), 0);
+        MeasureSerialization("int64", path, numbers);
+        Vector<std::string> strings(size);
+        for (std::string& str : strings) {
+            str = Sample<std::string>();
+        }
+        MeasureSerialization("string", path, strings);
+    }
+}
+
+// Строка аналитической таблицы: одна кэш-линия, из которой скан обычно читает одно-два поля
+struct Row {
+    int64_t id;
+    double timestamp;
+    float price;
+    int32_t quantity;
+    std::array<char, 40> tag;
+};
+
+using RowColumns = SoAVector<int64_t, double, float, int32_t, std::array<char, 40>>;
+
+// Скан одного-двух полей: Vector<Row> (AoS) против колонок SoAVector,
+// по колонке — простым циклом и векторными алгоритмами через Span
+void MeasureColumnScans(size_t size) {
+    Vector<Row> rows;
+    RowColumns columns;
+    rows.Reserve(size);
+    columns.Reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        const Row row{static_cast<int64_t>(i), static_cast<double>(i), static_cast<float>(i % 1000) / 4,
+                      static_cast<int32_t>(i % 100), {}};
+        rows.PushBack(row);
+        columns.EmplaceBack(row.id, row.timestamp, row.price, row.quantity, row.tag);
+    }
+    const Span<const float> prices = std::as_const(columns).Column<2>();
+    const Span<const int32_t> quantities = std::as_const(columns).Column<3>();
+
+    MeasureScan("sum_price", "aos", "row", size, [&] {
+        float sum = 0;
+        for (const Row& row : rows) {
+            sum += row.price;
+        }
+        return sum;
+    });
+    MeasureScan("sum_price", "soa", "row", size, [&] {
+        return std::accumulate(prices.begin(), prices.end(), 0.0f);
+    });
+    MeasureScan("sum_price", "soa_simd", "row", size, [&] {
+        return Sum(prices);
+    });
+    MeasureScan("count_quantity", "aos", "row", size, [&] {
+        return std::count_if(rows.begin(), rows.end(), [](const Row& row) {
+            return row.quantity == 42;
+        });
+    });
+    MeasureScan("count_quantity", "soa", "row", size, [&] {
+        return std::count(quantities.begin(), quantities.end(), 42);
+    });
+    MeasureScan("count_quantity", "soa_simd", "row", size, [&] {
+        return Count(quantities, 42);
+    });
+    // Два поля: выручка по строкам с заданным количеством
+    MeasureScan("revenue", "aos", "row", size, [&] {
+        double revenue = 0;
+        for (const Row& row : rows) {
+            revenue += row.quantity >= 50 ? static_cast<double>(row.price) * row.quantity : 0.0;
+        }
+        return revenue;
+    });
+    MeasureScan("revenue", "soa", "row", size, [&] {
+        double revenue = 0;
+        for (size_t i = 0; i < size; ++i) {
+            revenue += quantities[i] >= 50 ? static_cast<double>(prices[i]) * quantities[i] : 0.0;
+        }
+        return revenue;
+    });
+}
+
+// Структура массивов против массива структур на сканах одного поля, от L1 до основной памяти
+void BenchmarkSoA(size_t max_size) {
+    std::cout << "bench\timpl\ttype\tsize\tunit\tns\n";
+    for (size_t size = 1'000; size <= std::min<size_t>(max_size, 10'000'000); size *= 10) {
+        MeasureColumnScans(size);
+    }
+}
+
+// Раздача снимка таблицы fan_out обработчикам: время на один снимок
+template <typename Table>
+void MeasureFanOut(std::string_view impl, size_t size, size_t fan_out) {
+    using Clock = std::chrono::steady_clock;
+    Vector<int64_t> data(size);
+    std::iota(data.begin(), data.end(), 0);
+    const Table table(std::move(data));
+    const size_t reps = Repetitions(size * fan_out, 100'000'000);
+    std::vector<Table> snapshots;
+    snapshots.reserve(fan_out);
+    const auto start = Clock::now();
+    for (size_t rep = 0; rep < reps; ++rep) {
+        snapshots.clear();
+        for (size_t i = 0; i < fan_out; ++i) {
+            snapshots.push_back(table);
+        }
+        DoNotOptimize(snapshots.back()[size / 2]);
+    }
+    ReportOp("fan_out", impl, "int64", size, "op", Clock::now() - start, reps * fan_out);
+}
+
+// Снимки таблицы для обработчиков: глубокая копия Vector против CowVector
+void BenchmarkCow(size_t max_size) {
+    const size_t FAN_OUT = 16;
+    std::cout << "bench\timpl\ttype\tsize\tunit\tns\n";
+    for (size_t size = 1'000; size <= std::min<size_t>(max_size, 1'000'000); size *= 10) {
+        MeasureFanOut<Vector<int64_t>>("vector_copy", size, FAN_OUT);
+        MeasureFanOut<CowVector<int64_t>>("cow_vector", size, FAN_OUT);
+    }
+}
+
+// Сколько раз контейнеры с CountingAllocator сходили в кучу, на все типы элементов разом
+size_t num_counted_allocations = 0;
+
+// std::allocator, считающий выделения памяти
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() noexcept = default;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& /*other*/) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        ++num_counted_allocations;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        std::allocator<T>().deallocate(buf, n);
+    }
+
+    bool operator==(const CountingAllocator& /*other*/) const noexcept {
+        return true;
+    }
+
+    bool operator!=(const CountingAllocator& /*other*/) const noexcept {
+        return false;
+    }
+};
+
+// Сколько раз повторять каждую операцию над маленьким вектором
+const size_t SMALL_REPETITIONS = 200'000;
+
+// Время и число выделений памяти на одну операцию
+template <typename Body>
+void MeasureSmallOp(std::string_view bench, std::string_view impl, std::string_view type, size_t size, Body body) {
+    using Clock = std::chrono::steady_clock;
+    const size_t allocations_before = num_counted_allocations;
+    const auto start = Clock::now();
+    for (size_t rep = 0; rep < SMALL_REPETITIONS; ++rep) {
+        body();
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+    const size_t allocations = num_counted_allocations - allocations_before;
+    std::cout << bench << '\t' << impl << '\t' << type << '\t' << size << '\t'
+              << static_cast<double>(elapsed.count()) / static_cast<double>(SMALL_REPETITIONS) << '\t'
+              << static_cast<double>(allocations) / static_cast<double>(SMALL_REPETITIONS) << '\n';
+}
+
+// Жизненный цикл маленького вектора: построение PushBack'ами, вставка и удаление в середине,
+// копирование и перемещение. Выделения считает CountingAllocator (память самих элементов вроде
+// длинных строк в счёт не идёт)
+template <typename Container>
+void MeasureSmallVector(std::string_view impl, std::string_view type, size_t size) {
+    using T = typename Container::value_type;
+    const T sample = Sample<T>();
+    MeasureSmallOp("push_back", impl, type, size, [&] {
+        Container v;
+        for (size_t i = 0; i < size; ++i) {
+            v.PushBack(sample);
+        }
+        DoNotOptimize(v);
+    });
+
+    Container v;
+    for (size_t i = 0; i < size; ++i) {
+        v.PushBack(sample);
+    }
+    // Пара Emplace + Erase в середине: размер вектора после неё прежний
+    MeasureSmallOp("emplace_erase", impl, type, size, [&] {
+        v.Emplace(v.begin() + size / 2, sample);
+        v.Erase(v.begin() + size / 2);
+        DoNotOptimize(v);
+    });
+    MeasureSmallOp("copy", impl, type, size, [&] {
+        Container copy(v);
+        DoNotOptimize(copy);
+    });
+    MeasureSmallOp("move", impl, type, size, [&] {
+        Container moved(std::move(v));
+        DoNotOptimize(moved);
+        v = std::move(moved);
+    });
+}
+
+template <typename T>
+void BenchmarkSmallForType(std::string_view type) {
+    const size_t INLINE_CAPACITY = 8;
+    for (size_t size = 1; size <= 16; ++size) {
+        MeasureSmallVector<SmallVector<T, INLINE_CAPACITY, CountingAllocator<T>>>("SmallVector<8>", type, size);
+        MeasureSmallVector<Vector<T, CountingAllocator<T>>>("Vector", type, size);
+    }
+}
+
+// SmallVector<T, 8> против Vector на размерах 1–16, до и после переполнения встроенного буфера.
+// Формат: TSV, время и число выделений памяти на операцию
+void BenchmarkSmall() {
+    std::cout << "bench\timpl\ttype\tsize\tns_per_op\tallocs_per_op\n";
+    BenchmarkSmallForType<int>("int");
+    BenchmarkSmallForType<std::string>("string");
+}
+
+}  // namespace
+
+// benchmark [max_size] [suite]
+// Максимальный размер можно уменьшить, если не хватает памяти или времени.
+// suite — один из operations, relocation, shift, growth, huge_pages, alignment, concurrent, simd, parallel, mapped, serialization, soa, cow, small; без него запускаются все
+int main(int argc, char* argv[]) {
+    const size_t max_size = argc > 1 ? std::stoull(argv[1]) : 100'000'000;
+    const std::string_view suite = argc > 2 ? argv[2] : "";
+    auto selected = [&](std::string_view name) {
+        return suite.empty() || suite == name;
+    };
+    try {
+        if (selected("operations")) {
+            BenchmarkOperations(max_size);
+        }
+        if (selected("relocation")) {
+            BenchmarkRelocation(max_size);
+        }
+        if (selected("shift")) {
+            BenchmarkShift(max_size);
+        }
+        if (selected("growth")) {
+            BenchmarkGrowth(max_size);
+        }
+        if (selected("huge_pages")) {
+            BenchmarkHugePages(max_size);
+        }
+        if (selected("alignment")) {
+            BenchmarkAlignment(max_size);
+        }
+        if (selected("concurrent")) {
+            BenchmarkConcurrentAppend(max_size);
+        }
+        if (selected("simd")) {
+            BenchmarkSimd(max_size);
+        }
+        if (selected("parallel")) {
+            BenchmarkParallel(max_size);
+        }
+        if (selected("mapped")) {
+            BenchmarkMapped(max_size);
+        }
+        if (selected("serialization")) {
+            BenchmarkSerialization(max_size);
+        }
+        if (selected("soa")) {
+            BenchmarkSoA(max_size);
+        }
+        if (selected("cow")) {
+            BenchmarkCow(max_size);
+        }
+        if (selected("small")) {
+            BenchmarkSmall();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
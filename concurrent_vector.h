@@ -0,0 +1,233 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+
+// Вектор, в который могут одновременно дописывать несколько потоков.
+// Элементы лежат в сегментах RawMemory: нулевой на FIRST_SEGMENT элементов, каждый следующий вдвое больше.
+// Сегменты никогда не перевыделяются, поэтому элементы не переезжают, а ссылки на них живут до разрушения вектора.
+// EmplaceBack занимает ячейку одним fetch_add по размеру, без блокировок и повторов (wait-free).
+// Сегмент под следующую ячейку выделяется до этого, так что нехватка памяти обычно бросается
+// до занятия ячейки. Новый сегмент выделяет тот поток, которому он понадобился первым (CAS),
+// проигравшие гонку свою копию освобождают. Дескрипторы сегментов, как и сами элементы, выделяются
+// через Allocator.
+//
+// Если другие потоки успели увести размер в следующий, ещё не выделенный сегмент и выделить его
+// не удалось, занятая ячейка остаётся пустой. Тогда сегмент помечается потерянным: его больше
+// не выделяют, все ячейки в нём пустые, вставки в него бросают std::bad_alloc, а Size() не заходит
+// дальше его начала. Вектор после этого пригоден только для чтения уже вставленного и разрушения.
+//
+// Чтение по индексу безопасно параллельно с дописыванием, если элемент уже достроен: индекс получен
+// из EmplaceBack или передан от записавшего потока с синхронизацией. Size() считает занятые ячейки,
+// среди них могут быть ещё конструируемые элементы (как у tbb::concurrent_vector)
+template <typename T, typename Allocator = std::allocator<T>>
+class ConcurrentVector {
+    using Segment = RawMemory<T, Allocator>;
+    using SegmentAlloc = typename std::allocator_traits<Allocator>::template rebind_alloc<Segment>;
+    using SegmentAllocTraits = std::allocator_traits<SegmentAlloc>;
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+    static constexpr size_t LOG_FIRST_SEGMENT = 3;
+    static constexpr size_t FIRST_SEGMENT = size_t{1} << LOG_FIRST_SEGMENT;
+    static constexpr size_t MAX_SEGMENTS = sizeof(size_t) * 8 - LOG_FIRST_SEGMENT;
+
+    ConcurrentVector() = default;
+
+    explicit ConcurrentVector(const Allocator& alloc) noexcept
+        : alloc_(alloc) {}
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    // Разрушать вектор можно только когда все писатели закончили
+    // Потерянный сегмент пропускается: ячейки в нём не строились, а за ним могут быть выделенные сегменты
+    ~ConcurrentVector() {
+        size_t remaining = size_.load(std::memory_order_acquire);
+        for (size_t k = 0; k < MAX_SEGMENTS; ++k) {
+            Segment* segment = segments_[k].load(std::memory_order_acquire);
+            const size_t count = std::min(remaining, SegmentSize(k));
+            remaining -= count;
+            if (segment != nullptr && segment != LostSegment()) {
+                detail::DestroyN(segment->GetAddress(), count);
+                DeleteSegment(segment);
+            }
+        }
+    }
+
+    // Конструирует элемент в свободной ячейке и возвращает ссылку на него (она не инвалидируется).
+    // Если конструктор может бросить, элемент сначала строится во временном объекте, так что
+    // занятая ячейка всегда оказывается заполненной. Нехватку памяти под новый сегмент
+    // EmplaceBack сообщает исключением std::bad_alloc
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if constexpr (std::is_nothrow_constructible_v<T, Args&&...>) {
+            return *new (ClaimSlot()) T(std::forward<Args>(args)...);
+        } else {
+            static_assert(std::is_nothrow_move_constructible_v<T>,
+                          "ConcurrentVector needs either a noexcept constructor or a noexcept move");
+            T temp(std::forward<Args>(args)...);
+            return *new (ClaimSlot()) T(std::move(temp));
+        }
+    }
+
+    template <typename S>
+    T& PushBack(S&& value) {
+        return EmplaceBack(std::forward<S>(value));
+    }
+
+    // Заранее выделяет сегменты под capacity элементов, чтобы писатели не тратили время на выделение
+    void Reserve(size_t capacity) {
+        for (size_t k = 0; k < MAX_SEGMENTS && SegmentBegin(k) < capacity; ++k) {
+            EnsureSegment(k);
+        }
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<ConcurrentVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < Size());
+        const size_t k = SegmentIndex(index);
+        Segment* segment = segments_[k].load(std::memory_order_acquire);
+        return segment->GetAddress()[index - SegmentBegin(k)];
+    }
+
+    size_t Size() const noexcept {
+        return std::min(size_.load(std::memory_order_acquire), lost_from_.load(std::memory_order_acquire));
+    }
+
+    size_t Capacity() const noexcept {
+        size_t k = 0;
+        while (k < MAX_SEGMENTS) {
+            Segment* segment = segments_[k].load(std::memory_order_acquire);
+            if (segment == nullptr || segment == LostSegment()) {
+                break;
+            }
+            ++k;
+        }
+        return SegmentBegin(k);
+    }
+
+    Allocator GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+private:
+    // Размер k-го сегмента и индекс его первого элемента
+    static size_t SegmentSize(size_t k) noexcept {
+        return FIRST_SEGMENT << k;
+    }
+
+    static size_t SegmentBegin(size_t k) noexcept {
+        return k == MAX_SEGMENTS ? SIZE_MAX : (FIRST_SEGMENT << k) - FIRST_SEGMENT;
+    }
+
+    // Номер сегмента, в котором лежит элемент index: сдвинув индексы на FIRST_SEGMENT,
+    // получаем границы сегментов ровно на степенях двойки
+    static size_t SegmentIndex(size_t index) noexcept {
+        return FloorLog2(index + FIRST_SEGMENT) - LOG_FIRST_SEGMENT;
+    }
+
+    static size_t FloorLog2(size_t value) noexcept {
+#if defined(__GNUC__)
+        return sizeof(unsigned long long) * 8 - 1 - static_cast<size_t>(__builtin_clzll(value));
+#else
+        size_t result = 0;
+        while (value >>= 1) {
+            ++result;
+        }
+        return result;
+#endif
+    }
+
+    // Метка потерянного сегмента в segments_; по ней никогда не обращаются
+    static Segment* LostSegment() noexcept {
+        alignas(Segment) static char marker[sizeof(Segment)];
+        return reinterpret_cast<Segment*>(marker);
+    }
+
+    // Занимает следующую ячейку и возвращает её адрес. Сегмент под ячейку, которую скорее всего
+    // получит этот поток, выделяется заранее: если выделение бросит, ничего ещё не занято.
+    // Сегмент занятой ячейки приходится выделять уже после fetch_add, только если другие потоки
+    // успели пересечь границу сегмента
+    T* ClaimSlot() {
+        EnsureSegment(SegmentIndex(size_.load(std::memory_order_relaxed)));
+        const size_t index = size_.fetch_add(1, std::memory_order_relaxed);
+        const size_t k = SegmentIndex(index);
+        Segment* segment = segments_[k].load(std::memory_order_acquire);
+        if (segment == nullptr || segment == LostSegment()) {
+            try {
+                segment = EnsureSegment(k);
+            } catch (...) {
+                segment = LoseSegment(k);
+                if (segment == LostSegment()) {
+                    throw;
+                }
+            }
+        }
+        return segment->GetAddress() + (index - SegmentBegin(k));
+    }
+
+    // Возвращает k-й сегмент, выделяя его, если его ещё нет. Потерянный сегмент не выделяется
+    Segment* EnsureSegment(size_t k) {
+        Segment* segment = segments_[k].load(std::memory_order_acquire);
+        if (segment == nullptr) {
+            Segment* new_segment = NewSegment(SegmentSize(k));
+            if (segments_[k].compare_exchange_strong(segment, new_segment, std::memory_order_acq_rel,
+                                                      std::memory_order_acquire)) {
+                return new_segment;
+            }
+            // Сегмент успел выделить (или потерять) другой поток, segment теперь указывает на него
+            DeleteSegment(new_segment);
+        }
+        if (segment == LostSegment()) {
+            throw std::bad_alloc();
+        }
+        return segment;
+    }
+
+    // Занятой ячейке k-го сегмента не хватило памяти. Сегмент, который ещё никто не выделил,
+    // помечается потерянным, и тогда пусты все его ячейки. Если же его успел выделить другой поток,
+    // возвращается этот сегмент, и ячейка заполняется как обычно
+    Segment* LoseSegment(size_t k) noexcept {
+        Segment* segment = nullptr;
+        if (!segments_[k].compare_exchange_strong(segment, LostSegment(), std::memory_order_acq_rel,
+                                                  std::memory_order_acquire)
+            && segment != LostSegment()) {
+            return segment;
+        }
+        size_t lost_from = lost_from_.load(std::memory_order_relaxed);
+        while (SegmentBegin(k) < lost_from
+               && !lost_from_.compare_exchange_weak(lost_from, SegmentBegin(k), std::memory_order_release,
+                                                     std::memory_order_relaxed)) {
+        }
+        return LostSegment();
+    }
+
+    Segment* NewSegment(size_t capacity) {
+        SegmentAlloc alloc(alloc_);
+        Segment* segment = SegmentAllocTraits::allocate(alloc, 1);
+        try {
+            return new (segment) Segment(capacity, alloc_);
+        } catch (...) {
+            SegmentAllocTraits::deallocate(alloc, segment, 1);
+            throw;
+        }
+    }
+
+    void DeleteSegment(Segment* segment) noexcept {
+        SegmentAlloc alloc(alloc_);
+        segment->~Segment();
+        SegmentAllocTraits::deallocate(alloc, segment, 1);
+    }
+
+    Allocator alloc_ = Allocator();
+    std::atomic<size_t> size_ = 0;
+    // Начало первого потерянного сегмента: Size() за него не заходит
+    std::atomic<size_t> lost_from_ = SIZE_MAX;
+    std::atomic<Segment*> segments_[MAX_SEGMENTS] = {};
+};
@@ -0,0 +1,278 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+
+// Вектор с копированием при записи.
+// Копии делят один буфер: блок со счётчиком ссылок и обычным Vector внутри. Копирование и
+// присваивание только увеличивают счётчик — O(1) и без обращений к куче, так что снимок таблицы
+// можно раздать сколько угодно потокам. Чтение идёт прямо из общего буфера без блокировок.
+// Первое изменение общего буфера копирует его (сразу с местом под изменение), дальше копия своя.
+// Как и shared_ptr, разные копии можно читать и менять из разных потоков одновременно,
+// а один и тот же объект CowVector — нет.
+// Изменяемого operator[] нет, чтобы случайная запись через неконстантный объект не копировала буфер:
+// для правки по месту есть Mutable().
+// Аллокатор хранится рядом с блоком: пустой вектор без блока и копия общего буфера берут память из него
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth>
+class CowVector {
+public:
+    using VectorType = Vector<T, Allocator, GrowthPolicy>;
+    using value_type = T;
+    using allocator_type = Allocator;
+    using const_iterator = const T*;
+    using iterator = const_iterator;
+
+    const_iterator begin() const noexcept {
+        return block_ != nullptr ? block_->data.begin() : nullptr;
+    }
+    const_iterator end() const noexcept {
+        return block_ != nullptr ? block_->data.end() : nullptr;
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    // Пустой вектор блока не заводит
+    CowVector() = default;
+
+    explicit CowVector(const Allocator& alloc) noexcept
+        : alloc_(alloc) {}
+
+    explicit CowVector(size_t size, const Allocator& alloc = Allocator())
+        : CowVector(VectorType(size, alloc)) {}
+
+    // Забирает буфер data без копирования элементов; аллокатор data остаётся и у пустого вектора
+    explicit CowVector(VectorType&& data)
+        : alloc_(data.GetAllocator())
+        , block_(data.Capacity() != 0 ? NewBlock(std::move(data)) : nullptr) {}
+
+    // Общий буфер остаётся со своим аллокатором, а для будущих копий аллокатор выбирается как у контейнеров
+    CowVector(const CowVector& other) noexcept
+        : alloc_(AllocTraits::select_on_container_copy_construction(other.alloc_))
+        , block_(Acquire(other.block_)) {}
+
+    CowVector(CowVector&& other) noexcept
+        : alloc_(other.alloc_)
+        , block_(std::exchange(other.block_, nullptr)) {}
+
+    // Блок освобождается собственным аллокатором, так что передать его можно при любых аллокаторах
+    CowVector& operator=(const CowVector& rhs) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+            alloc_ = rhs.alloc_;
+        }
+        if (block_ != rhs.block_) {
+            Release(std::exchange(block_, Acquire(rhs.block_)));
+        }
+        return *this;
+    }
+
+    CowVector& operator=(CowVector&& rhs) noexcept {
+        if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                alloc_ = rhs.alloc_;
+            }
+            Release(std::exchange(block_, std::exchange(rhs.block_, nullptr)));
+        }
+        return *this;
+    }
+
+    void Swap(CowVector& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        }
+        std::swap(block_, other.block_);
+    }
+
+    ~CowVector() {
+        Release(block_);
+    }
+
+    Allocator GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    size_t Size() const noexcept {
+        return block_ != nullptr ? block_->data.Size() : 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return block_ != nullptr ? block_->data.Capacity() : 0;
+    }
+
+    // Сколько CowVector делят буфер (0, если буфера нет)
+    size_t UseCount() const noexcept {
+        return block_ != nullptr ? block_->refs.load(std::memory_order_relaxed) : 0;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        assert(index < Size());
+        return block_->data[index];
+    }
+
+    // Собственный Vector для произвольных правок: общий буфер при этом копируется.
+    // Ссылка действительна, пока этот CowVector не скопируют, не присвоят или не разрушат
+    VectorType& Mutable() {
+        const SharedBlock old(Detach(Size()));
+        return block_->data;
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > Capacity()) {
+            const SharedBlock old(Detach(new_capacity));
+            block_->data.Reserve(new_capacity);
+        }
+    }
+
+    // Из общего буфера копируется только то, что останется
+    void Resize(size_t new_size) {
+        const SharedBlock old(Detach(new_size, std::min(new_size, Size())));
+        block_->data.Resize(new_size);
+    }
+
+    // Общий буфер не копируется, а просто отпускается
+    void Clear() noexcept {
+        if (block_ != nullptr && IsShared()) {
+            Release(std::exchange(block_, nullptr));
+        } else if (block_ != nullptr) {
+            block_->data.Clear();
+        }
+    }
+
+    template <typename... Args>
+    const T& EmplaceBack(Args&&... args) {
+        // Аргументы могут ссылаться на элементы общего буфера, поэтому он отпускается после вставки
+        const SharedBlock old(Detach(GrowthCapacity()));
+        return block_->data.EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    template <typename S>
+    void PushBack(S&& value) {
+        EmplaceBack(std::forward<S>(value));
+    }
+
+    void PopBack() {
+        assert(Size() > 0);
+        Resize(Size() - 1);
+    }
+
+    template <typename... Args>
+    const_iterator Emplace(const_iterator pos, Args&&... args) {
+        const size_t index = pos - begin();
+        const SharedBlock old(Detach(GrowthCapacity()));
+        return block_->data.Emplace(block_->data.begin() + index, std::forward<Args>(args)...);
+    }
+
+    const_iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    const_iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    // Итераторы могут указывать в общий буфер: после копирования они пересчитываются по индексам
+    const_iterator Erase(const_iterator pos) {
+        return Erase(pos, pos + 1);
+    }
+
+    const_iterator Erase(const_iterator first, const_iterator last) {
+        const size_t index = first - begin();
+        const size_t count = last - first;
+        const SharedBlock old(Detach(Size()));
+        VectorType& data = block_->data;
+        return data.Erase(data.begin() + index, data.begin() + index + count);
+    }
+
+private:
+    struct Block {
+        explicit Block(VectorType&& data) noexcept
+            : data(std::move(data)) {}
+
+        std::atomic<size_t> refs = 1;
+        VectorType data;
+    };
+
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using BlockAlloc = typename AllocTraits::template rebind_alloc<Block>;
+    using BlockAllocTraits = std::allocator_traits<BlockAlloc>;
+
+    // Ссылка на блок, которая отпускается в деструкторе
+    class SharedBlock {
+    public:
+        explicit SharedBlock(Block* block) noexcept
+            : block_(block) {}
+
+        SharedBlock(const SharedBlock&) = delete;
+        SharedBlock& operator=(const SharedBlock&) = delete;
+
+        ~SharedBlock() {
+            Release(block_);
+        }
+
+    private:
+        Block* block_;
+    };
+
+    static Block* NewBlock(VectorType&& data) {
+        BlockAlloc alloc(data.GetAllocator());
+        Block* block = BlockAllocTraits::allocate(alloc, 1);
+        return new (block) Block(std::move(data));
+    }
+
+    static Block* Acquire(Block* block) noexcept {
+        if (block != nullptr) {
+            // Новая ссылка берётся от уже существующей, упорядочивать тут нечего (как в shared_ptr)
+            block->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+        return block;
+    }
+
+    // Последний владелец видит все записи остальных до их Release и разрушает блок
+    static void Release(Block* block) noexcept {
+        if (block != nullptr && block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            BlockAlloc alloc(block->data.GetAllocator());
+            block->~Block();
+            BlockAllocTraits::deallocate(alloc, block, 1);
+        }
+    }
+
+    // Вместимость копии общего буфера перед вставкой: с запасом по GrowthPolicy, как при обычном росте
+    size_t GrowthCapacity() const noexcept {
+        return GrowthPolicy::NextCapacity(Size(), Size() + 1, sizeof(T));
+    }
+
+    // acquire: если другие владельцы только что отпустили блок, их чтения завершились до наших записей
+    bool IsShared() const noexcept {
+        return block_->refs.load(std::memory_order_acquire) != 1;
+    }
+
+    // Делает буфер своим, чтобы его можно было менять. Из общего буфера копируются первые keep
+    // элементов (по умолчанию все) в новый с вместимостью не меньше min_capacity, свой остаётся как есть.
+    // Возвращает отпущенный общий блок (или nullptr): вызывающий держит его до конца изменения
+    [[nodiscard]] Block* Detach(size_t min_capacity, size_t keep = SIZE_MAX) {
+        if (block_ == nullptr) {
+            block_ = NewBlock(VectorType(alloc_));
+            return nullptr;
+        }
+        if (!IsShared()) {
+            return nullptr;
+        }
+        const VectorType& shared = block_->data;
+        VectorType copy(alloc_);
+        keep = std::min(keep, shared.Size());
+        copy.Reserve(std::max(min_capacity, keep));
+        copy.Append(shared.begin(), shared.begin() + keep);
+        return std::exchange(block_, NewBlock(std::move(copy)));
+    }
+
+    Allocator alloc_;
+    Block* block_ = nullptr;
+};
+
+// CowVector — аллокатор и указатель на блок
+template <typename T, typename Allocator, typename GrowthPolicy>
+struct IsTriviallyRelocatable<CowVector<T, Allocator, GrowthPolicy>> : IsTriviallyRelocatable<Allocator> {};
@@ -1,122 +1,84 @@
 #include "vector.h"
+#include "small_vector.h"
+#include "concurrent_vector.h"
+#include "stable_vector.h"
+#include "simd_algorithms.h"
+#include "parallel_algorithms.h"
+#include "mapped_vector.h"
+#include "serialization.h"
+#include "soa_vector.h"
+#include "cow_vector.h"
+#include "test_types.h"
 
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <memory_resource>
+#include <numeric>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
-namespace {
-
-// "Магическое" число, используемое для отслеживания живости объекта
-inline const uint32_t DEFAULT_COOKIE = 0xdeadbeef;
-
-struct TestObj {
-    TestObj() = default;
-    TestObj(const TestObj& other) = default;
-    TestObj& operator=(const TestObj& other) = default;
-    TestObj(TestObj&& other) = default;
-    TestObj& operator=(TestObj&& other) = default;
-    ~TestObj() {
-        cookie = 0;
-    }
-    [[nodiscard]] bool IsAlive() const noexcept {
-        return cookie == DEFAULT_COOKIE;
-    }
-    uint32_t cookie = DEFAULT_COOKIE;
-};
-
-struct Obj {
-    Obj() {
-        if (default_construction_throw_countdown > 0) {
-            if (--default_construction_throw_countdown == 0) {
-                throw std::runtime_error("Oops");
-            }
-        }
-        ++num_default_constructed;
-    }
-
-    explicit Obj(int id)
-        : id(id)  //
-    {
-        ++num_constructed_with_id;
-    }
-
-    Obj(int id, std::string name)
-        : id(id)
-        , name(std::move(name))  //
-    {
-        ++num_constructed_with_id_and_name;
-    }
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
-    Obj(const Obj& other)
-        : id(other.id)  //
-    {
-        if (other.throw_on_copy) {
-            throw std::runtime_error("Oops");
-        }
-        ++num_copied;
-    }
-
-    Obj(Obj&& other) noexcept
-        : id(other.id)  //
-    {
-        ++num_moved;
-    }
-
-    Obj& operator=(const Obj& other) {
-        if (this != &other) {
-            id = other.id;
-            name = other.name;
-            ++num_assigned;
-        }
-        return *this;
-    }
-
-    Obj& operator=(Obj&& other) noexcept {
-        id = other.id;
-        name = std::move(other.name);
-        ++num_move_assigned;
-        return *this;
-    }
+// Глобальные operator new/delete подменены, чтобы тесты могли проверять точное число обращений к куче.
+// Остальные формы (new[], nothrow, sized delete) по стандарту сводятся к этим
+namespace {
+std::atomic<size_t> num_heap_allocations = 0;
+std::atomic<size_t> num_heap_deallocations = 0;
+}  // namespace
 
-    ~Obj() {
-        ++num_destroyed;
-        id = 0;
+void* operator new(size_t size) {
+    ++num_heap_allocations;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
     }
+    throw std::bad_alloc();
+}
 
-    static int GetAliveObjectCount() {
-        return num_default_constructed + num_copied + num_moved + num_constructed_with_id
-            + num_constructed_with_id_and_name - num_destroyed;
+void* operator new(size_t size, std::align_val_t alignment) {
+    ++num_heap_allocations;
+    const size_t align = static_cast<size_t>(alignment);
+    // aligned_alloc требует размер, кратный выравниванию
+    if (void* p = std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align)) {
+        return p;
     }
+    throw std::bad_alloc();
+}
 
-    static void ResetCounters() {
-        default_construction_throw_countdown = 0;
-        num_default_constructed = 0;
-        num_copied = 0;
-        num_moved = 0;
-        num_destroyed = 0;
-        num_constructed_with_id = 0;
-        num_constructed_with_id_and_name = 0;
-        num_assigned = 0;
-        num_move_assigned = 0;
+// GCC, встроив эти функции, видит free() для памяти из operator new и ложно ругается
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept {
+    if (p != nullptr) {
+        ++num_heap_deallocations;
     }
+    std::free(p);
+}
 
-    bool throw_on_copy = false;
-    int id = 0;
-    std::string name;
+void operator delete(void* p, size_t /*size*/) noexcept {
+    operator delete(p);
+}
 
-    static inline int default_construction_throw_countdown = 0;
-    static inline int num_default_constructed = 0;
-    static inline int num_constructed_with_id = 0;
-    static inline int num_constructed_with_id_and_name = 0;
-    static inline int num_copied = 0;
-    static inline int num_moved = 0;
-    static inline int num_destroyed = 0;
-    static inline int num_assigned = 0;
-    static inline int num_move_assigned = 0;
-};
+void operator delete(void* p, std::align_val_t /*alignment*/) noexcept {
+    operator delete(p);
+}
 
-}  // namespace
+void operator delete(void* p, size_t /*size*/, std::align_val_t /*alignment*/) noexcept {
+    operator delete(p);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
 
 void Test1() {
     Obj::ResetCounters();
@@ -558,85 +520,2181 @@ void Test6() {
     }
 }
 
-struct C {
-    C() noexcept {
-        ++def_ctor;
+// Ресурс памяти, подсчитывающий выделения и освобождения
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t num_allocations = 0;
+    size_t num_deallocations = 0;
+    size_t bytes_in_use = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++num_allocations;
+        bytes_in_use += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
     }
-    C(const C& /*other*/) noexcept {
-        ++copy_ctor;
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        ++num_deallocations;
+        bytes_in_use -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
     }
-    C(C&& /*other*/) noexcept {
-        ++move_ctor;
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
     }
-    C& operator=(const C& other) noexcept {
-        if (this != &other) {
-            ++copy_assign;
-        }
-        return *this;
+};
+
+// Потокобезопасный ресурс с ограниченным запасом байт: сверх запаса бросает std::bad_alloc
+class BoundedResource : public std::pmr::memory_resource {
+public:
+    explicit BoundedResource(size_t budget) noexcept
+        : budget_(budget) {}
+
+    size_t BytesInUse() const noexcept {
+        return bytes_in_use_.load();
     }
-    C& operator=(C&& /*other*/) noexcept {
-        ++move_assign;
-        return *this;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        size_t budget = budget_.load();
+        do {
+            if (bytes > budget) {
+                throw std::bad_alloc();
+            }
+        } while (!budget_.compare_exchange_weak(budget, budget - bytes));
+        bytes_in_use_ += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        bytes_in_use_ -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::atomic<size_t> budget_;
+    std::atomic<size_t> bytes_in_use_ = 0;
+};
+
+// Аллокатор с состоянием, который распространяется при копировании, перемещении и обмене
+template <typename T>
+struct TaggedAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    explicit TaggedAllocator(int tag = 0) noexcept
+        : tag(tag) {}
+
+    template <typename U>
+    TaggedAllocator(const TaggedAllocator<U>& other) noexcept
+        : tag(other.tag) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t /*n*/) noexcept {
+        operator delete(p);
     }
-    ~C() {
-        ++dtor;
+
+    bool operator==(const TaggedAllocator& other) const noexcept {
+        return tag == other.tag;
     }
 
-    static void Reset() {
-        def_ctor = 0;
-        copy_ctor = 0;
-        move_ctor = 0;
-        copy_assign = 0;
-        move_assign = 0;
-        dtor = 0;
+    bool operator!=(const TaggedAllocator& other) const noexcept {
+        return !(*this == other);
     }
 
-    inline static size_t def_ctor = 0;
-    inline static size_t copy_ctor = 0;
-    inline static size_t move_ctor = 0;
-    inline static size_t copy_assign = 0;
-    inline static size_t move_assign = 0;
-    inline static size_t dtor = 0;
+    int tag = 0;
 };
 
-void Dump() {
-    using namespace std;
-    cerr << "Def ctors: "sv << C::def_ctor              //
-         << ", Copy ctors: "sv << C::copy_ctor          //
-         << ", Move ctors: "sv << C::move_ctor          //
-         << ", Copy assignments: "sv << C::copy_assign  //
-         << ", Move assignments: "sv << C::move_assign  //
-         << ", Dtors: "sv << C::dtor << endl;
+void Test7() {
+    const size_t SIZE = 100;
+    {
+        CountingResource resource;
+        {
+            pmr::Vector<int> v(&resource);
+            for (size_t i = 0; i < SIZE; ++i) {
+                v.PushBack(static_cast<int>(i));
+            }
+            assert(v.Size() == SIZE);
+            assert(resource.num_allocations > 0);
+            assert(v.GetAllocator().resource() == &resource);
+
+            // polymorphic_allocator не распространяется при копировании
+            pmr::Vector<int> v_copy(v);
+            assert(v_copy.GetAllocator().resource() == std::pmr::get_default_resource());
+            assert(v_copy[SIZE - 1] == static_cast<int>(SIZE - 1));
+
+            const size_t num_allocations = resource.num_allocations;
+            pmr::Vector<int> v_moved(std::move(v));
+            assert(v_moved.GetAllocator().resource() == &resource);
+            assert(resource.num_allocations == num_allocations);
+            assert(v_moved.Size() == SIZE);
+            assert(v.Size() == 0);
+        }
+        assert(resource.num_allocations == resource.num_deallocations);
+        assert(resource.bytes_in_use == 0);
+    }
+    {
+        // Перемещающее присваивание между разными ресурсами переносит элементы поэлементно
+        CountingResource resource1;
+        CountingResource resource2;
+        {
+            Obj::ResetCounters();
+            pmr::Vector<Obj> v1(SIZE, &resource1);
+            pmr::Vector<Obj> v2(&resource2);
+            v2 = std::move(v1);
+            assert(v2.Size() == SIZE);
+            assert(v2.GetAllocator().resource() == &resource2);
+            assert(resource2.num_allocations == 1);
+            assert(Obj::num_moved == SIZE);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+        assert(resource1.bytes_in_use == 0);
+        assert(resource2.bytes_in_use == 0);
+    }
+    {
+        using TaggedVector = Vector<int, TaggedAllocator<int>>;
+        TaggedVector v1(SIZE, TaggedAllocator<int>(1));
+        TaggedVector v2(SIZE / 2, TaggedAllocator<int>(2));
+        v1[0] = 42;
+
+        v2 = v1;
+        assert(v2.GetAllocator().tag == 1);
+        assert(v2.Size() == SIZE);
+        assert(v2[0] == 42);
+
+        TaggedVector v3(TaggedAllocator<int>(3));
+        v3 = std::move(v1);
+        assert(v3.GetAllocator().tag == 1);
+        assert(v3.Size() == SIZE);
+
+        TaggedVector v4(1, TaggedAllocator<int>(4));
+        v4.Swap(v3);
+        assert(v4.GetAllocator().tag == 1);
+        assert(v3.GetAllocator().tag == 4);
+        assert(v4.Size() == SIZE);
+        assert(v3.Size() == 1);
+    }
 }
 
-void Benchmark() {
-    using namespace std;
-    try {
-        const size_t NUM = 10;
-        C c;
+void Test8() {
+    const size_t SIZE = 1000;
+    struct Point {
+        int64_t x = 0;
+        int64_t y = 0;
+    };
+    static_assert(std::is_trivially_copyable_v<Point>);
+    {
+        Vector<int64_t> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int64_t>(i));
+        }
+        v.Reserve(SIZE * 3);
+        assert(v.Capacity() == SIZE * 3);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i] == static_cast<int64_t>(i));
+        }
+
+        Vector<int64_t> v_copy(v);
+        assert(v_copy.Size() == SIZE);
+        assert(v_copy[SIZE - 1] == static_cast<int64_t>(SIZE - 1));
+
+        Vector<int64_t> v_small(SIZE / 2);
+        v_small.Reserve(SIZE);
+        v_small = v;
+        assert(v_small.Size() == SIZE);
+        assert(v_small[SIZE - 1] == static_cast<int64_t>(SIZE - 1));
+    }
+    {
+        Vector<Point> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i] = {static_cast<int64_t>(i), -static_cast<int64_t>(i)};
+        }
+        assert(v.Size() == v.Capacity());
+        auto* pos = v.Emplace(v.cbegin() + SIZE / 2, Point{-1, -1});
+        assert(pos == &v[SIZE / 2]);
+        assert(v.Size() == SIZE + 1);
+        assert(v[SIZE / 2].x == -1);
+        assert(v[SIZE / 2 - 1].x == static_cast<int64_t>(SIZE / 2 - 1));
+        assert(v[SIZE / 2 + 1].x == static_cast<int64_t>(SIZE / 2));
+        assert(v[SIZE].y == -static_cast<int64_t>(SIZE - 1));
+    }
+}
+
+void Test9() {
+    // Маленький порог, чтобы пройти и через realloc, и через mremap, и через переход между ними
+    using ReallocVector = Vector<uint32_t, ReallocAllocator<uint32_t, 4096>>;
+    const size_t SIZE = 100'000;
+    {
+        ReallocVector v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<uint32_t>(i));
+        }
+        assert(v.Size() == SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i] == i);
+        }
+
+        v.Reserve(SIZE * 4);
+        assert(v.Capacity() == SIZE * 4);
+        assert(v[SIZE - 1] == SIZE - 1);
+
+        const ReallocVector v_copy(v);
+        assert(v_copy.Size() == SIZE);
+        assert(v_copy[SIZE / 2] == SIZE / 2);
+    }
+    {
+        ReallocVector v(SIZE);
+        v[0] = 42;
+        assert(v.Size() == v.Capacity());
+        // Элемент самого вектора должен пережить перенос блока
+        v.PushBack(v[0]);
+        assert(v[SIZE] == 42);
+
+        ReallocVector v_full(4);
+        v_full[3] = 7;
+        auto* pos = v_full.Emplace(v_full.cbegin() + 1, v_full[3]);
+        assert(pos == &v_full[1]);
+        assert(v_full.Size() == 5);
+        assert(v_full.Capacity() == 8);
+        assert(v_full[1] == 7);
+        assert(v_full[4] == 7);
+    }
+}
+
+void Test10() {
+    const size_t SIZE = 10;
+    {
+        Vector<int, std::allocator<int>, OneAndHalfGrowth> v;
+        std::vector<size_t> capacities;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+            if (capacities.empty() || capacities.back() != v.Capacity()) {
+                capacities.push_back(v.Capacity());
+            }
+        }
+        assert((capacities == std::vector<size_t>{1, 2, 3, 4, 6, 9, 13}));
+
+        v.Emplace(v.cbegin(), -1);
+        v.Emplace(v.cbegin(), -2);
+        v.Emplace(v.cbegin(), -3);
+        v.Emplace(v.cbegin(), -4);
+        assert(v.Size() == SIZE + 4);
+        assert(v.Capacity() == 19);
+        assert(v[0] == -4);
+        assert(v[SIZE + 3] == static_cast<int>(SIZE - 1));
+    }
+    {
+        using SizeClassVector = Vector<char, std::allocator<char>, MallocSizeClassGrowth<>>;
+        SizeClassVector v;
+        v.PushBack('a');
+        // Даже самый маленький чанк malloc вмещает 24 байта
+        assert(v.Capacity() == 24);
+        for (size_t i = 0; i < 1000; ++i) {
+            v.PushBack('b');
+        }
+        assert(v.Size() == 1001);
+        assert(v[0] == 'a');
+        assert(v[1000] == 'b');
+        // 24 -> 56 -> 120 -> 248 -> 504 -> 1016: каждый раз округление до чанка 16k + 8
+        assert(v.Capacity() == 1016);
+    }
+#ifdef __GLIBC__
+    {
+        // Модель размеров блоков сверяем с тем, что malloc выделяет на самом деле
+        for (size_t bytes = 1; bytes < 300'000; bytes = bytes * 3 / 2 + 1) {
+            const size_t usable = MallocSizeClassGrowth<>::NextCapacity(0, bytes, 1);
+            assert(usable >= bytes);
+            void* buf = std::malloc(usable);
+            assert(malloc_usable_size(buf) >= usable);
+            // Вместимость должна заканчиваться там же, где кончается выделенный блок
+            if (usable < 128 * 1024) {
+                assert(malloc_usable_size(buf) == usable);
+            }
+            std::free(buf);
+        }
+        // Выше порога mmap блок — целые страницы: округлённый запрос занимает те же страницы, что и исходный
+        for (size_t bytes : {size_t(40) << 20, (size_t(40) << 20) + 4072, (size_t(40) << 20) + 4073}) {
+            const size_t usable = MallocSizeClassGrowth<>::NextCapacity(0, bytes, 1);
+            assert(usable >= bytes && usable < bytes + 4096);
+            assert(MallocSizeClassGrowth<>::NextCapacity(0, usable, 1) == usable);
+#ifndef __SANITIZE_ADDRESS__
+            // ASan подменяет malloc, и размеры блоков у него свои
+            void* buf = std::malloc(bytes);
+            void* rounded = std::malloc(usable);
+            assert(malloc_usable_size(rounded) == malloc_usable_size(buf));
+            std::free(rounded);
+            std::free(buf);
+#endif
+        }
+    }
+#endif
+    static_assert(IsMallocBacked<std::allocator<int>>::value && IsMallocBacked<ReallocAllocator<int>>::value);
+    static_assert(!IsMallocBacked<AlignedAllocator<int>>::value);
+    static_assert(!IsMallocBacked<std::pmr::polymorphic_allocator<int>>::value);
+}
+
+void Test11() {
+    const size_t INLINE_SIZE = 8;
+    using namespace std::literals;
+    {
+        CountingResource resource;
         {
-            cerr << "std::vector:"sv << endl;
-            C::Reset();
-            vector<C> v(NUM);
-            Dump();
-            v.push_back(c);
+            SmallVector<int, INLINE_SIZE, std::pmr::polymorphic_allocator<int>> v(&resource);
+            for (size_t i = 0; i < INLINE_SIZE; ++i) {
+                v.PushBack(static_cast<int>(i));
+            }
+            assert(v.IsInline());
+            assert(v.Capacity() == INLINE_SIZE);
+            assert(resource.num_allocations == 0);
+
+            v.Emplace(v.cbegin(), -1);
+            assert(!v.IsInline());
+            assert(resource.num_allocations == 1);
+            assert(v.Size() == INLINE_SIZE + 1);
+            assert(v.Capacity() == INLINE_SIZE * 2);
+            assert(v[0] == -1);
+            assert(v[INLINE_SIZE] == static_cast<int>(INLINE_SIZE - 1));
         }
-        Dump();
-    } catch (...) {
+        assert(resource.bytes_in_use == 0);
     }
-    try {
-        const size_t NUM = 10;
-        C c;
+    {
+        Obj::ResetCounters();
         {
-            cerr << "Vector:"sv << endl;
-            C::Reset();
-            Vector<C> v(NUM);
-            Dump();
-            v.PushBack(c);
+            SmallVector<Obj, INLINE_SIZE> v;
+            v.EmplaceBack(1);
+            v.EmplaceBack(3);
+            v.Emplace(v.cbegin() + 1, 2);
+            assert(v.Size() == 3);
+            assert(v[0].id == 1 && v[1].id == 2 && v[2].id == 3);
+
+            SmallVector<Obj, INLINE_SIZE> v_copy(v);
+            assert(v_copy.IsInline());
+            assert(v_copy[2].id == 3);
+
+            SmallVector<Obj, INLINE_SIZE> v_moved(std::move(v_copy));
+            assert(v_moved.Size() == 3);
+            assert(v_copy.Size() == 0);
+
+            v_moved.Erase(v_moved.cbegin());
+            assert(v_moved.Size() == 2);
+            assert(v_moved[0].id == 2);
+
+            v_moved.Resize(INLINE_SIZE * 3);
+            assert(!v_moved.IsInline());
+            assert(v_moved[1].id == 3);
+
+            v = v_moved;
+            assert(v.Size() == INLINE_SIZE * 3);
+            v.Swap(v_copy);
+            assert(v.Size() == 0);
+            assert(v_copy.Size() == INLINE_SIZE * 3);
+
+            SmallVector<Obj, INLINE_SIZE> v_heap;
+            v_heap = std::move(v_moved);
+            assert(!v_heap.IsInline());
+            assert(v_heap[0].id == 2);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        SmallVector<std::string, 2> v;
+        v.PushBack("a"s);
+        v.PushBack("b"s);
+        // Элемент самого вектора должен пережить переезд в кучу
+        v.PushBack(v[0]);
+        v.Insert(v.cbegin(), v[2]);
+        assert(v.Size() == 4);
+        assert(v[0] == "a"s && v[1] == "a"s && v[2] == "b"s && v[3] == "a"s);
+    }
+}
+
+void Test12() {
+    const size_t SIZE = 10;
+    const size_t COUNT = 4;
+    {
+        // Вставка с реаллокацией: каждый старый элемент переносится ровно один раз
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        std::vector<Obj> values;
+        for (size_t i = 0; i < COUNT; ++i) {
+            values.emplace_back(static_cast<int>(i + 1));
+        }
+        const int old_moved = Obj::num_moved;
+        const int old_copied = Obj::num_copied;
+        auto pos = v.Insert(v.cbegin() + 2, values.begin(), values.end());
+        assert(pos == &v[2]);
+        assert(v.Size() == SIZE + COUNT);
+        assert(v.Capacity() == SIZE * 2);
+        assert(v[2].id == 1 && v[5].id == 4 && v[6].id == 0);
+        assert(Obj::num_moved - old_moved == static_cast<int>(SIZE));
+        assert(Obj::num_copied - old_copied == static_cast<int>(COUNT));
+    }
+    {
+        // Вставка без реаллокации, хвост длиннее вставки и короче вставки
+        Vector<int> v;
+        v.Reserve(SIZE * 2);
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(i);
+        }
+        v.Insert(v.cbegin() + 1, {100, 101});
+        assert(v.Size() == SIZE + 2);
+        assert(v[0] == 0 && v[1] == 100 && v[2] == 101 && v[3] == 1 && v[SIZE + 1] == 9);
+
+        const std::vector<int> values = {200, 201, 202, 203, 204};
+        v.Insert(v.cend() - 2, values.begin(), values.end());
+        assert(v.Size() == SIZE + 7);
+        assert(v.Capacity() == SIZE * 2);
+        assert(v[SIZE] == 200 && v[SIZE + 4] == 204 && v[SIZE + 5] == 8 && v[SIZE + 6] == 9);
+
+        v.Insert(v.cbegin(), 3, v[SIZE + 6]);
+        assert(v.Size() == SIZE + 10);
+        assert(v[0] == 9 && v[2] == 9 && v[3] == 0);
+        v.Insert(v.cend() - 1, 2, v[SIZE + 9]);
+        assert(v.Size() == SIZE + 12);
+        assert(v[SIZE + 9] == 9 && v[SIZE + 10] == 9 && v[SIZE + 11] == 9);
+        assert(v.Insert(v.cend(), 0, 1) == v.end());
+    }
+    {
+        // Однопроходный диапазон
+        std::istringstream input("1 2 3");
+        Vector<int> v(2);
+        v.Insert(v.cbegin() + 1, std::istream_iterator<int>(input), std::istream_iterator<int>());
+        assert(v.Size() == 5);
+        assert(v[0] == 0 && v[1] == 1 && v[2] == 2 && v[3] == 3 && v[4] == 0);
+    }
+    {
+        Vector<uint32_t, ReallocAllocator<uint32_t, 64>> v(SIZE);
+        v[SIZE - 1] = 7;
+        v.Insert(v.cbegin(), SIZE * 3, v[SIZE - 1]);
+        assert(v.Size() == SIZE * 4);
+        assert(v[0] == 7 && v[SIZE * 3 - 1] == 7 && v[SIZE * 3] == 0 && v[SIZE * 4 - 1] == 7);
+    }
+}
+
+void Test13() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        auto pos = v.Erase(v.cbegin() + 10, v.cbegin() + 30);
+        assert(pos == &v[10]);
+        assert(v.Size() == SIZE - 20);
+        assert(v.Capacity() >= SIZE);
+        assert(v[9].id == 9 && v[10].id == 30 && v[SIZE - 21].id == static_cast<int>(SIZE - 1));
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE - 20));
+        assert(v.Erase(v.cbegin() + 5, v.cbegin() + 5) == &v[5]);
+        v.Erase(v.cbegin(), v.cend());
+        assert(v.Size() == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        const size_t removed = EraseIf(v, [](const Obj& obj) {
+            return obj.id % 3 == 0;
+        });
+        assert(removed == SIZE / 3 + 1);
+        assert(v.Size() == SIZE - removed);
+        assert(std::none_of(v.begin(), v.end(), [](const Obj& obj) {
+            return obj.id % 3 == 0;
+        }));
+        assert(v[0].id == 1 && v[1].id == 2 && v[2].id == 4);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(v.Size()));
+    }
+    {
+        Vector<int> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(i);
+        }
+        assert(EraseIf(v, [](int x) { return x < 0; }) == 0);
+        assert(v.Size() == SIZE);
+        assert(EraseIf(v, [](int x) { return x % 2 == 1; }) == SIZE / 2);
+        assert(v.Size() == SIZE / 2);
+        for (size_t i = 0; i < v.Size(); ++i) {
+            assert(v[i] == static_cast<int>(i * 2));
+        }
+        assert(EraseIf(v, [](int) { return true; }) == SIZE / 2);
+        assert(v.Size() == 0);
+    }
+    {
+        // Крупные POD уплотняются участками выживших
+        struct Record {
+            int64_t id;
+            int64_t payload[7];
+        };
+        Vector<Record> v;
+        for (int64_t i = 0; i < static_cast<int64_t>(SIZE); ++i) {
+            v.PushBack(Record{i, {i, i, i, i, i, i, -i}});
+        }
+        // Выжившие идут участками разной длины, в том числе в самом конце
+        const size_t removed = EraseIf(v, [](const Record& r) {
+            return r.id % 7 == 0 || r.id % 7 == 3 || r.id % 7 == 4;
+        });
+        assert(v.Size() == SIZE - removed);
+        size_t i = 0;
+        for (int64_t id = 0; id < static_cast<int64_t>(SIZE); ++id) {
+            if (id % 7 != 0 && id % 7 != 3 && id % 7 != 4) {
+                assert(v[i].id == id && v[i].payload[0] == id && v[i].payload[6] == -id);
+                ++i;
+            }
+        }
+        assert(i == v.Size());
+        const int64_t last = v[v.Size() - 1].id;
+        const int64_t before_last = v[v.Size() - 2].id;
+        assert(EraseIf(v, [last](const Record& r) { return r.id == last; }) == 1);
+        assert(v[v.Size() - 1].id == before_last);
+    }
+}
+
+void Test14() {
+    const size_t SIZE = 10;
+    using namespace std::literals;
+    {
+        const std::vector<int> values = {1, 2, 3, 4, 5};
+        Vector<int> v(values.begin(), values.end());
+        assert(v.Size() == values.size());
+        assert(v.Capacity() == values.size());
+        assert(v[0] == 1 && v[4] == 5);
+
+        v.Append(values.begin(), values.end());
+        assert(v.Size() == values.size() * 2);
+        assert(v.Capacity() == values.size() * 2);
+        assert(v[5] == 1 && v[9] == 5);
+
+        v.Append(v);
+        assert(v.Size() == values.size() * 4);
+        assert(v[10] == 1 && v[19] == 5);
+
+        std::istringstream input("7 8 9");
+        v.Append(std::istream_iterator<int>(input), std::istream_iterator<int>(), 3);
+        assert(v.Size() == values.size() * 4 + 3);
+        assert(v[20] == 7 && v[22] == 9);
+
+        std::istringstream input_ctor("1 2");
+        Vector<int> v_input(std::istream_iterator<int>(input_ctor), std::istream_iterator<int>{});
+        assert(v_input.Size() == 2 && v_input[1] == 2);
+    }
+    {
+        // Серия Append растёт по политике, а не реаллоцируется каждый раз
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        Vector<Obj> batch(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.Append(batch);
+        }
+        assert(v.Size() == SIZE * SIZE);
+        assert(v.Capacity() == SIZE * 16);
+        assert(Obj::num_copied == static_cast<int>(SIZE * SIZE));
+        assert(Obj::num_moved == static_cast<int>(SIZE + SIZE * 2 + SIZE * 4 + SIZE * 8));
+
+        const int old_moved = Obj::num_moved;
+        v.Append(std::move(batch));
+        assert(batch.Size() == 0);
+        assert(v.Size() == SIZE * SIZE + SIZE);
+        assert(Obj::num_moved - old_moved == static_cast<int>(SIZE));
+
+        Vector<Obj> v_empty;
+        v_empty.Append(std::move(v));
+        assert(v_empty.Size() == SIZE * SIZE + SIZE);
+        assert(v.Size() == 0);
+        assert(Obj::num_moved - old_moved == static_cast<int>(SIZE));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<std::string> v(SIZE);
+        const std::vector<std::string> words = {"a"s, "b"s, "c"s};
+        v.Assign(words.begin(), words.end());
+        assert(v.Size() == 3);
+        assert(v.Capacity() == SIZE);
+        assert(v[0] == "a"s && v[2] == "c"s);
+
+        v.Assign(SIZE * 2, v[1]);
+        assert(v.Size() == SIZE * 2);
+        assert(v.Capacity() == SIZE * 2);
+        assert(v[0] == "b"s && v[SIZE * 2 - 1] == "b"s);
+
+        v.Assign(SIZE / 2, "x"s);
+        assert(v.Size() == SIZE / 2);
+        assert(v[SIZE / 2 - 1] == "x"s);
+        v.Assign(SIZE, v[0]);
+        assert(v.Size() == SIZE);
+        assert(v[SIZE - 1] == "x"s);
+
+        std::istringstream input("p q");
+        v.Assign(std::istream_iterator<std::string>(input), std::istream_iterator<std::string>());
+        assert(v.Size() == 2);
+        assert(v[0] == "p"s && v[1] == "q"s);
+
+        v.Clear();
+        assert(v.Size() == 0);
+        assert(v.Capacity() == SIZE * 2);
+    }
+}
+
+void Test15() {
+    const size_t SMALL_SIZE = 100;
+    const size_t LARGE_SIZE = 1'000'000;
+    HugePageOptions options;
+    options.threshold = 1 << 20;
+    options.prefault = true;
+    options.lock = true;
+    using HugeVector = Vector<uint64_t, HugePageAllocator<uint64_t>>;
+    {
+        HugeVector v(SMALL_SIZE, HugePageAllocator<uint64_t>(options));
+        v[SMALL_SIZE - 1] = 42;
+        assert(v.GetAllocator().GetOptions().prefault);
+
+        HugeVector v_large(LARGE_SIZE, HugePageAllocator<uint64_t>(options));
+#ifdef __linux__
+        assert(reinterpret_cast<uintptr_t>(&v_large[0]) % HugePageAllocator<uint64_t>::HUGE_PAGE_SIZE == 0);
+#endif
+        for (size_t i = 0; i < LARGE_SIZE; ++i) {
+            assert(v_large[i] == 0);
+            v_large[i] = i;
+        }
+        v_large.PushBack(LARGE_SIZE);
+        assert(v_large.Size() == LARGE_SIZE + 1);
+        assert(v_large[LARGE_SIZE / 2] == LARGE_SIZE / 2);
+
+        // Настройки распространяются вместе с буфером
+        HugeVector v_copy;
+        v_copy = v_large;
+        assert(v_copy.GetAllocator().GetOptions().threshold == options.threshold);
+        assert(v_copy[LARGE_SIZE] == LARGE_SIZE);
+
+        v = std::move(v_copy);
+        assert(v.Size() == LARGE_SIZE + 1);
+        assert(v[LARGE_SIZE - 1] == LARGE_SIZE - 1);
+    }
+}
+
+void Test16() {
+    const size_t SIZE = 100;
+    const unsigned char MAGIC = 0xAB;
+    {
+        Vector<unsigned char> v(SIZE);
+        std::fill(v.begin(), v.end(), MAGIC);
+        v.Resize(SIZE / 2);
+        // Память под элементы уже есть: после ResizeUninitialized в ней остались прежние байты
+        v.ResizeUninitialized(SIZE);
+        assert(v.Size() == SIZE);
+        assert(v[SIZE - 1] == MAGIC);
+
+        v.Resize(SIZE / 2);
+        v.ResizeDefaultInit(SIZE);
+        assert(v[SIZE - 1] == MAGIC);
+
+        v.ResizeUninitialized(SIZE * 2);
+        assert(v.Size() == SIZE * 2);
+        assert(v.Capacity() == SIZE * 2);
+        assert(v[SIZE / 2] == MAGIC);
+        v.ResizeDefaultInit(1);
+        assert(v.Size() == 1);
+    }
+    {
+        Vector<uint64_t> v(SIZE, DEFAULT_INIT);
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() == SIZE);
+        std::fill(v.begin(), v.end(), 1);
+        assert(std::accumulate(v.begin(), v.end(), uint64_t{0}) == SIZE);
+    }
+    {
+        // Для классов инициализация по умолчанию — это конструктор по умолчанию
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE, DEFAULT_INIT);
+        v.ResizeDefaultInit(SIZE * 2);
+        assert(Obj::num_default_constructed == static_cast<int>(SIZE * 2));
+        v.ResizeDefaultInit(SIZE);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE));
+    }
+}
+
+// Блок шириной в регистр AVX
+struct alignas(32) AvxBlock {
+    float lanes[8] = {};
+};
+
+// Структура, выровненная на кэш-линию (против false sharing)
+struct alignas(64) CacheLinePadded {
+    int64_t value = 0;
+};
+
+template <typename T>
+bool IsAligned(const T* ptr, size_t alignment) {
+    return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+void Test17() {
+    const size_t SIZE = 1000;
+    {
+        Vector<AvxBlock> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(AvxBlock{});
+            assert(IsAligned(&v[0], alignof(AvxBlock)));
+        }
+        v.Emplace(v.cbegin() + 1);
+        assert(IsAligned(&v[0], alignof(AvxBlock)));
+
+        Vector<CacheLinePadded> v_padded(SIZE);
+        assert(IsAligned(&v_padded[0], 64));
+        v_padded.Reserve(SIZE * 3);
+        assert(IsAligned(&v_padded[0], 64));
+        assert(&v_padded[1] - &v_padded[0] == 1);
+    }
+    {
+        AlignedVector<float> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<float>(i));
+            assert(IsAligned(&v[0], 64));
+        }
+        AlignedVector<float> v_copy(v);
+        assert(IsAligned(&v_copy[0], 64));
+        assert(v_copy[SIZE - 1] == static_cast<float>(SIZE - 1));
+
+        AlignedVector<AvxBlock, 16> v_blocks(SIZE);
+        assert(IsAligned(&v_blocks[0], alignof(AvxBlock)));
+    }
+    {
+        HugePageOptions options;
+        options.threshold = SIZE_MAX;
+        Vector<CacheLinePadded, HugePageAllocator<CacheLinePadded>> v(SIZE, HugePageAllocator<CacheLinePadded>(options));
+        assert(IsAligned(&v[0], 64));
+
+        CountingResource resource;
+        pmr::Vector<AvxBlock> v_pmr(SIZE, &resource);
+        assert(IsAligned(&v_pmr[0], alignof(AvxBlock)));
+
+        SmallVector<AvxBlock, 3> v_small(2);
+        assert(IsAligned(&v_small[0], alignof(AvxBlock)));
+        v_small.Resize(SIZE);
+        assert(IsAligned(&v_small[0], alignof(AvxBlock)));
+    }
+}
+
+void Test18() {
+    const size_t SIZE = 1000;
+    {
+        Vector<int> v;
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        // Без политики сжатия вместимость остаётся на пике
+        v.Resize(10);
+        assert(v.Capacity() >= SIZE);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 10);
+        assert(v[9] == 9);
+        v.Clear();
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 2);
+        v.Erase(v.begin() + 10, v.end());
+        v.ShrinkToFit();
+        assert(v.Capacity() == 10);
+        assert(Obj::GetAliveObjectCount() == 10);
+    }
+    {
+        Vector<int, ReallocAllocator<int>> v(SIZE);
+        v[SIZE / 2] = 42;
+        v.Resize(SIZE / 2 + 1);
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE / 2 + 1);
+        assert(v[SIZE / 2] == 42);
+    }
+    {
+        using ShrinkingVector = Vector<int, std::allocator<int>, ShrinkOnUnderflow<DoublingGrowth, 4, 16>>;
+        ShrinkingVector v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        const size_t peak = v.Capacity();
+        // Выше четверти вместимости буфер не трогается
+        while (v.Size() > peak / 4) {
+            v.PopBack();
+        }
+        assert(v.Capacity() == peak);
+        v.PopBack();
+        assert(v.Capacity() == v.Size() * 2);
+        assert(v[v.Size() - 1] == static_cast<int>(v.Size() - 1));
+
+        // Колебания у порога не перевыделяют память
+        const size_t shrunk = v.Capacity();
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
+            v.PopBack();
+        }
+        assert(v.Capacity() == shrunk);
+
+        const int last = v[v.Size() - 1];
+        auto it = v.Erase(v.begin() + 1, v.end() - 1);
+        assert(v.Size() == 2);
+        assert(v.Capacity() == 16);
+        assert(*it == last);
+        v.Resize(0);
+        assert(v.Capacity() == 16);
+    }
+    {
+        CountingResource resource;
+        pmr::Vector<std::string, ShrinkOnUnderflow<>> v(&resource);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(std::to_string(i));
+        }
+        EraseIf(v, [](const std::string& s) {
+            return s.size() > 1;
+        });
+        assert(v.Size() == 10);
+        assert(v.Capacity() == 20);
+        assert(v[9] == "9");
+        assert(resource.bytes_in_use == 20 * sizeof(std::string));
+    }
+}
+
+void Test19() {
+    const size_t SIZE = 100;
+    if constexpr (!VECTOR_STATS_ENABLED) {
+        // Выключенный учёт не стоит ни байта
+        assert(sizeof(Vector<int>) == sizeof(RawMemory<int>) + sizeof(size_t));
+        Vector<int> v(SIZE);
+        v.PushBack(1);
+        assert(v.GetStats().reallocations == 0);
+        assert(v.GetStats().peak_capacity == 0);
+        return;
+    }
+    {
+        Vector<int> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        // Удвоение: 1, 2, 4, ..., 128 — восемь буферов, первый не считается реаллокацией
+        VectorStats stats = v.GetStats();
+        assert(stats.reallocations == 7);
+        assert(stats.peak_capacity == 128);
+        assert(stats.bytes_allocated == 255 * sizeof(int));
+        assert(stats.bytes_relocated == 127 * sizeof(int));
+        assert(stats.elements_moved == 127);
+        assert(stats.elements_copied == 0);
+        assert(stats.elements_shifted == 0);
+
+        v.ResetStats();
+        v.Emplace(v.begin() + 10, 0);
+        v.Erase(v.begin());
+        v.Erase(v.end() - 10, v.end());
+        v.Insert(v.begin() + 1, 3, 7);
+        stats = v.GetStats();
+        assert(stats.reallocations == 0);
+        assert(stats.elements_shifted == (SIZE - 10) + SIZE + 0 + (SIZE - 10 - 1));
+
+        Vector<int> v_copy(v);
+        assert(v_copy.GetStats().elements_copied == v.Size());
+        assert(v_copy.GetStats().peak_capacity == v.Size());
+        // Статистика остаётся у объекта, а не переезжает вместе с буфером
+        Vector<int> v_moved(std::move(v_copy));
+        assert(v_moved.GetStats().elements_copied == 0);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 2);
+        v.ShrinkToFit();
+        const VectorStats stats = v.GetStats();
+        assert(stats.reallocations == 2);
+        assert(stats.bytes_relocated == SIZE * 2 * sizeof(Obj));
+        assert(stats.elements_moved == static_cast<size_t>(Obj::num_moved));
+        assert(stats.elements_copied == 0);
+    }
+}
+
+// Обращения к куче с момента создания счётчика
+class HeapCounter {
+public:
+    size_t Allocations() const noexcept {
+        return num_heap_allocations - allocations_;
+    }
+
+    size_t Deallocations() const noexcept {
+        return num_heap_deallocations - deallocations_;
+    }
+
+private:
+    size_t allocations_ = num_heap_allocations;
+    size_t deallocations_ = num_heap_deallocations;
+};
+
+void Test20() {
+    const size_t SIZE = 1000;
+    {
+        HeapCounter heap;
+        Vector<int> v;
+        Vector<int> v_copy(v);
+        v.Reserve(0);
+        v.Resize(0);
+        v.Clear();
+        v.ShrinkToFit();
+        v = v_copy;
+        v = std::move(v_copy);
+        assert(heap.Allocations() == 0);
+    }
+    {
+        Vector<Obj> v(SIZE);
+        HeapCounter heap;
+        // Перемещение и обмен только передают буфер
+        Vector<Obj> v_moved(std::move(v));
+        v = std::move(v_moved);
+        v.Swap(v_moved);
+        v_moved.Swap(v);
+        Vector<Obj> v_other;
+        v_other = std::move(v);
+        v = std::move(v_other);
+        v.Append(std::move(v_other));
+        v_other.Append(std::move(v));
+        v.Swap(v_other);
+        assert(heap.Allocations() == 0);
+        assert(heap.Deallocations() == 0);
+        assert(v.Size() == SIZE);
+    }
+    {
+        HeapCounter heap;
+        {
+            Vector<int> v;
+            for (size_t i = 0; i < SIZE; ++i) {
+                v.PushBack(static_cast<int>(i));
+            }
+            // Буферы на 1, 2, 4, ..., 1024 элемента
+            assert(heap.Allocations() == 11);
+            assert(heap.Deallocations() == 10);
+        }
+        assert(heap.Deallocations() == 11);
+    }
+    {
+        HeapCounter heap;
+        Vector<int> v(SIZE);
+        Vector<int> v_default(SIZE, DEFAULT_INIT);
+        Vector<int> v_range(v.begin(), v.end());
+        Vector<int> v_copy(v);
+        assert(heap.Allocations() == 4);
+    }
+    {
+        Vector<int> v(SIZE);
+        HeapCounter heap;
+        // Всё, что помещается в текущую вместимость, кучу не трогает
+        v.Reserve(SIZE);
+        v.Resize(SIZE / 2);
+        v.Resize(SIZE);
+        v.Erase(v.begin());
+        v.Emplace(v.begin(), 1);
+        v.Erase(v.begin(), v.begin() + 10);
+        v.Insert(v.begin(), 10, 5);
+        EraseIf(v, [](int x) {
+            return x == 5;
+        });
+        v.Assign(SIZE / 2, 7);
+        v.Append(v.begin(), v.begin() + 10);
+        v.Clear();
+        v.Resize(SIZE);
+        assert(heap.Allocations() == 0);
+
+        // Рост: ровно один новый буфер и одно освобождение старого
+        v.EmplaceBack(1);
+        assert(heap.Allocations() == 1);
+        assert(heap.Deallocations() == 1);
+        v.Insert(v.begin(), v.Capacity(), 2);
+        assert(heap.Allocations() == 2);
+        assert(heap.Deallocations() == 2);
+        v.ShrinkToFit();
+        assert(heap.Allocations() == 3);
+        assert(heap.Deallocations() == 3);
+
+        Vector<int> v_copy;
+        v_copy = v;
+        assert(heap.Allocations() == 4);
+        v_copy = v;
+        assert(heap.Allocations() == 4);
+        v.Append(v_copy);
+        assert(heap.Allocations() == 5);
+        assert(heap.Deallocations() == 4);
+    }
+    {
+        HeapCounter heap;
+        SmallVector<int, 8> v;
+        for (int i = 0; i < 8; ++i) {
+            v.PushBack(i);
+        }
+        SmallVector<int, 8> v_copy(v);
+        SmallVector<int, 8> v_moved(std::move(v_copy));
+        assert(heap.Allocations() == 0);
+        v.PushBack(8);
+        assert(heap.Allocations() == 1);
+        SmallVector<int, 8> v_heap_moved(std::move(v));
+        assert(heap.Allocations() == 1);
+    }
+}
+
+void Test21() {
+    const size_t PREFILLED = 1000;
+    const size_t NUM_THREADS = 4;
+    const size_t PER_THREAD = 20000;
+    {
+        ConcurrentVector<size_t> v;
+        for (size_t i = 0; i < PREFILLED; ++i) {
+            v.PushBack(i);
+        }
+        const size_t* first = &v[0];
+
+        std::vector<std::thread> writers;
+        for (size_t t = 0; t < NUM_THREADS; ++t) {
+            writers.emplace_back([&v, t] {
+                std::vector<size_t*> written;
+                for (size_t i = 0; i < PER_THREAD; ++i) {
+                    written.push_back(&v.EmplaceBack(PREFILLED + t * PER_THREAD + i));
+                }
+                // Другие потоки всё это время дописывали, но элементы не переехали
+                for (size_t i = 0; i < PER_THREAD; ++i) {
+                    assert(*written[i] == PREFILLED + t * PER_THREAD + i);
+                }
+            });
+        }
+        // Уже достроенные элементы можно читать параллельно с дописыванием
+        std::thread reader([&v] {
+            for (int pass = 0; pass < 10; ++pass) {
+                size_t sum = 0;
+                for (size_t i = 0; i < PREFILLED; ++i) {
+                    sum += v[i];
+                }
+                assert(sum == PREFILLED * (PREFILLED - 1) / 2);
+            }
+        });
+        for (auto& writer : writers) {
+            writer.join();
+        }
+        reader.join();
+
+        const size_t total = PREFILLED + NUM_THREADS * PER_THREAD;
+        assert(v.Size() == total);
+        assert(&v[0] == first);
+        assert(v.Capacity() >= total);
+        std::vector<size_t> values;
+        for (size_t i = 0; i < total; ++i) {
+            values.push_back(v[i]);
+        }
+        std::sort(values.begin(), values.end());
+        for (size_t i = 0; i < total; ++i) {
+            assert(values[i] == i);
+        }
+    }
+    {
+        // Границы сегментов: 8, 16, 32, ... элементов
+        Obj::ResetCounters();
+        {
+            ConcurrentVector<Obj> v;
+            v.Reserve(100);
+            assert(v.Capacity() == 120);
+            for (int i = 0; i < 200; ++i) {
+                assert(v.EmplaceBack(i).id == i);
+            }
+            for (int i = 0; i < 200; ++i) {
+                assert(v[i].id == i);
+            }
+            assert(v.Capacity() == 248);
+            // Конструктор Obj может бросить: элемент строится во временном объекте и перемещается
+            const int moved = Obj::num_moved;
+            Obj& obj = v.EmplaceBack(1000, std::string("name"));
+            assert(obj.id == 1000);
+            assert(Obj::num_moved == moved + 1);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        CountingResource resource;
+        {
+            ConcurrentVector<std::string, std::pmr::polymorphic_allocator<std::string>> v(&resource);
+            v.EmplaceBack("a");
+            v.PushBack(std::string(100, 'b'));
+            assert(v[1].size() == 100);
+            // Сегмент и его дескриптор
+            assert(resource.num_allocations == 2);
+        }
+        assert(resource.bytes_in_use == 0);
+    }
+    {
+        // Нехватка памяти под сегмент долетает до вызывающего, а занятых пустых ячеек не остаётся
+        alignas(std::max_align_t) char buffer[1024];
+        std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        ConcurrentVector<int64_t, std::pmr::polymorphic_allocator<int64_t>> v(&resource);
+        int64_t pushed = 0;
+        try {
+            for (;; ++pushed) {
+                v.PushBack(pushed);
+            }
+        } catch (const std::bad_alloc&) {
+        }
+        assert(pushed > 0 && v.Size() == static_cast<size_t>(pushed));
+        for (int64_t i = 0; i < pushed; ++i) {
+            assert(v[static_cast<size_t>(i)] == i);
+        }
+    }
+    {
+        // То же при гонке писателей: ячейка, чей сегмент выделить не удалось, может быть уже занята.
+        // Size() не включает пустых ячеек, а деструктор не трогает их
+        for (int round = 0; round < 20; ++round) {
+            BoundedResource resource(64 * 1024);
+            {
+                ConcurrentVector<std::string, std::pmr::polymorphic_allocator<std::string>> v(&resource);
+                std::atomic<size_t> pushed = 0;
+                std::vector<std::thread> writers;
+                for (size_t t = 0; t < NUM_THREADS; ++t) {
+                    writers.emplace_back([&v, &pushed, t] {
+                        try {
+                            for (size_t i = 0;; ++i) {
+                                v.EmplaceBack(std::to_string(t) + ':' + std::string(32, 'x') + std::to_string(i));
+                                ++pushed;
+                            }
+                        } catch (const std::bad_alloc&) {
+                        }
+                    });
+                }
+                for (auto& writer : writers) {
+                    writer.join();
+                }
+                assert(v.Size() > 0 && v.Size() <= pushed);
+                for (size_t i = 0; i < v.Size(); ++i) {
+                    assert(v[i].size() > 32);
+                }
+                // Вставки после нехватки памяти снова бросают, не портя вектор
+                const size_t size = v.Size();
+                try {
+                    for (int i = 0; i < 1000; ++i) {
+                        v.EmplaceBack("late");
+                    }
+                } catch (const std::bad_alloc&) {
+                }
+                assert(v.Size() >= size);
+            }
+            assert(resource.BytesInUse() == 0);
+        }
+    }
+}
+
+void Test22() {
+    const size_t SIZE = 10000;
+    {
+        StableVector<int, 64> v;
+        std::vector<int*> addresses;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+            addresses.push_back(&v[i]);
+        }
+        // Рост только добавлял блоки: все указатели на месте
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(addresses[i] == &v[i]);
+            assert(*addresses[i] == static_cast<int>(i));
+        }
+        assert(v.Capacity() == (SIZE + 63) / 64 * 64);
+
+        auto it = v.begin() + 100;
+        v.Resize(SIZE * 2);
+        assert(*it == 100);
+        assert(addresses[SIZE - 1] == &v[SIZE - 1]);
+        assert(v[SIZE * 2 - 1] == 0);
+
+        v.Resize(SIZE);
+        // Итераторы произвольного доступа: работают алгоритмы STL
+        assert(v.end() - v.begin() == static_cast<std::ptrdiff_t>(SIZE));
+        assert(std::is_sorted(v.begin(), v.end()));
+        assert(*std::lower_bound(v.cbegin(), v.cend(), 4242) == 4242);
+        std::reverse(v.begin(), v.end());
+        assert(v[0] == static_cast<int>(SIZE - 1));
+        assert(addresses[0] == &v[0]);
+        std::sort(v.begin(), v.end());
+        assert(v[SIZE - 1] == static_cast<int>(SIZE - 1));
+        StableVector<int, 64>::const_iterator cit = v.begin();
+        assert(cit[5] == 5);
+        assert(cit == v.begin() && cit != v.end() && cit < v.end());
+        // Итераторы разных векторов не равны, даже если индексы совпадают
+        const StableVector<int, 64> other(SIZE);
+        assert(other.begin() != cit && other.end() != v.end());
+        assert(std::accumulate(v.begin(), v.end(), size_t{0}) == SIZE * (SIZE - 1) / 2);
+
+        v.Resize(10);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 64);
+        assert(addresses[9] == &v[9]);
+    }
+    {
+        Obj::ResetCounters();
+        {
+            StableVector<Obj> v;
+            static_assert(StableVector<Obj>::CHUNK_SIZE * sizeof(Obj) <= 4096);
+            for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+                v.EmplaceBack(i);
+            }
+            // Рост не перемещает и не копирует элементы
+            assert(Obj::num_moved == 0);
+            assert(Obj::num_copied == 0);
+
+            StableVector<Obj> v_copy(v);
+            assert(Obj::num_copied == static_cast<int>(SIZE));
+            assert(v_copy[SIZE - 1].id == static_cast<int>(SIZE - 1));
+
+            Obj* first = &v[0];
+            StableVector<Obj> v_moved(std::move(v));
+            assert(&v_moved[0] == first);
+            assert(v.Size() == 0);
+            v = std::move(v_moved);
+            assert(&v[0] == first);
+            v_copy = v;
+            v.Swap(v_copy);
+            assert(&v_copy[0] == first);
+            v.Clear();
+            assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE));
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        CountingResource resource;
+        {
+            StableVector<int, 16, std::pmr::polymorphic_allocator<int>> v(100, &resource);
+            assert(v.Size() == 100);
+            // 7 блоков по 16 и таблица блоков
+            assert(resource.num_allocations == 8);
+        }
+        assert(resource.bytes_in_use == 0);
+    }
+}
+
+// Векторные варианты на всех уровнях, доступных процессору, сверяются со скалярным
+template <typename T>
+void CheckSimdAlgorithms(size_t size) {
+    Vector<T> v(size);
+    for (size_t i = 0; i < size; ++i) {
+        // Повторы, отрицательные значения и экстремумы в разных местах, в том числе в хвосте
+        v[i] = static_cast<T>(static_cast<int>((i * 7919) % 101) - 50);
+    }
+    const T needle = static_cast<T>(-50 + static_cast<int>(size % 101));
+    SetSimdLevel(SimdLevel::SCALAR);
+    const size_t expected_find = Find(v, needle) - v.begin();
+    const size_t expected_count = Count(v, needle);
+    const auto expected_sum = Sum(v);
+    assert(expected_find == static_cast<size_t>(std::find(v.begin(), v.end(), needle) - v.begin()));
+    assert(expected_count == static_cast<size_t>(std::count(v.begin(), v.end(), needle)));
+
+    for (SimdLevel level : {SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (SetSimdLevel(level) != level) {
+            continue;
+        }
+        assert(static_cast<size_t>(Find(v, needle) - v.begin()) == expected_find);
+        assert(Count(v, needle) == expected_count);
+        assert(Contains(v, needle) == (expected_count > 0));
+        assert(!Contains(v, static_cast<T>(1000)));
+        // Слагаемые — небольшие целые, так что и сумма float точна при любом порядке
+        assert(Sum(v) == expected_sum);
+        if (size > 0) {
+            const auto [lo, hi] = MinMax(v);
+            assert(lo == *std::min_element(v.begin(), v.end()));
+            assert(hi == *std::max_element(v.begin(), v.end()));
+        }
+        for (CompareOp op : {CompareOp::LESS, CompareOp::LESS_EQUAL, CompareOp::EQUAL, CompareOp::NOT_EQUAL,
+                             CompareOp::GREATER_EQUAL, CompareOp::GREATER}) {
+            Vector<T> out;
+            out.PushBack(static_cast<T>(42));
+            const size_t count = Filter(v, op, static_cast<T>(3), out);
+            assert(out.Size() == count + 1);
+            assert(out[0] == static_cast<T>(42));
+            SetSimdLevel(SimdLevel::SCALAR);
+            Vector<T> expected;
+            assert(Filter(v, op, static_cast<T>(3), expected) == count);
+            SetSimdLevel(level);
+            assert(std::equal(expected.begin(), expected.begin() + count, out.begin() + 1));
+        }
+    }
+    SetSimdLevel(SimdLevel::AVX512);
+}
+
+void Test23() {
+    for (size_t size : {0, 1, 7, 15, 16, 17, 33, 255, 256, 257, 1000, 4099}) {
+        CheckSimdAlgorithms<int32_t>(size);
+        CheckSimdAlgorithms<float>(size);
+        CheckSimdAlgorithms<int16_t>(size);
+        CheckSimdAlgorithms<double>(size);
+    }
+    {
+        // Сумма int32 не переполняется
+        Vector<int32_t> v(1000);
+        std::fill(v.begin(), v.end(), std::numeric_limits<int32_t>::max());
+        assert(Sum(v) == int64_t{1000} * std::numeric_limits<int32_t>::max());
+        std::fill(v.begin(), v.end(), std::numeric_limits<int32_t>::min());
+        assert(Sum(v) == int64_t{1000} * std::numeric_limits<int32_t>::min());
+        v[999] = 5;
+        assert(*Find(v, 5) == 5 && Find(v, 5) == v.end() - 1);
+        assert(MinMax(v) == std::make_pair(std::numeric_limits<int32_t>::min(), 5));
+    }
+    // Уровень выше поддерживаемого понижается
+    assert(SetSimdLevel(SimdLevel::AVX512) == GetSimdLevel());
+}
+
+void Test24() {
+    {
+        // Задачи, поставленные из задач, и вложенные группы не взаимоблокируются даже на одном рабочем
+        for (size_t workers : {0, 1, 3}) {
+            ThreadPool pool(workers);
+            assert(pool.Concurrency() == workers + 1);
+            std::atomic<int> counter = 0;
+            TaskGroup outer(pool);
+            for (int i = 0; i < 20; ++i) {
+                outer.Run([&] {
+                    TaskGroup inner(pool);
+                    for (int j = 0; j < 10; ++j) {
+                        inner.Run([&] {
+                            ++counter;
+                        });
+                    }
+                    inner.Wait();
+                });
+            }
+            outer.Wait();
+            assert(counter == 200);
+
+            TaskGroup failing(pool);
+            for (int i = 0; i < 10; ++i) {
+                failing.Run([i] {
+                    if (i == 7) {
+                        throw std::runtime_error("task failed");
+                    }
+                });
+            }
+            try {
+                failing.Wait();
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            // Ошибка пробрасывается один раз
+            failing.Wait();
+        }
+    }
+    for (size_t workers : {0, 1, 3}) {
+        ThreadPool pool(workers);
+        // Размеры вокруг границ блоков: блок int — 16 КиБ, то есть 4096 элементов
+        for (size_t size : {0, 1, 1000, 4096, 4097, 50'000, 100'001}) {
+            Vector<int> v(size);
+            std::iota(v.begin(), v.end(), 0);
+            std::reverse(v.begin(), v.end());
+            std::vector<int> expected(v.begin(), v.end());
+
+            ForEach(pool, v, [](int& x) {
+                x = x * 7 % 1000;
+            });
+            std::for_each(expected.begin(), expected.end(), [](int& x) {
+                x = x * 7 % 1000;
+            });
+            assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+
+            Vector<int64_t> squares;
+            Transform(pool, v, squares, [](int x) {
+                return int64_t{x} * x;
+            });
+            assert(squares.Size() == size);
+            for (size_t i = 0; i < size; i += 997) {
+                assert(squares[i] == int64_t{expected[i]} * expected[i]);
+            }
+
+            assert(Reduce(pool, v, int64_t{5}) == std::accumulate(expected.begin(), expected.end(), int64_t{5}));
+
+            Vector<int> scanned;
+            InclusiveScan(pool, v, scanned);
+            std::vector<int> expected_scan(size);
+            std::partial_sum(expected.begin(), expected.end(), expected_scan.begin());
+            assert(std::equal(scanned.begin(), scanned.end(), expected_scan.begin(), expected_scan.end()));
+            InclusiveScan(pool, v, v);
+            assert(std::equal(v.begin(), v.end(), expected_scan.begin(), expected_scan.end()));
+
+            Sort(pool, v, std::greater<>());
+            std::sort(expected_scan.begin(), expected_scan.end(), std::greater<>());
+            assert(std::equal(v.begin(), v.end(), expected_scan.begin(), expected_scan.end()));
+        }
+        {
+            // Нетривиальный тип и некоммутативная операция: порядок свёртки сохраняется
+            Vector<std::string> words(5'000);
+            for (size_t i = 0; i < words.Size(); ++i) {
+                words[i] = std::to_string(i * 7919 % 5'000);
+            }
+            std::vector<std::string> expected(words.begin(), words.end());
+            const std::string joined = Reduce(pool, words, std::string("^"));
+            assert(joined == std::accumulate(expected.begin(), expected.end(), std::string("^")));
+            Sort(pool, words);
+            std::sort(expected.begin(), expected.end());
+            assert(std::equal(words.begin(), words.end(), expected.begin(), expected.end()));
+        }
+        {
+            Vector<int> v(100'000);
+            std::iota(v.begin(), v.end(), 0);
+            try {
+                ForEach(pool, v, [](int& x) {
+                    if (x == 77'777) {
+                        throw std::out_of_range("bad element");
+                    }
+                    ++x;
+                });
+                assert(false);
+            } catch (const std::out_of_range&) {
+            }
+            try {
+                Transform(pool, v, v, [](int x) -> int {
+                    throw std::invalid_argument(std::to_string(x));
+                });
+                assert(false);
+            } catch (const std::invalid_argument&) {
+            }
+        }
+    }
+}
+
+void Test25() {
+    struct Record {
+        int64_t id;
+        double value;
+        char name[16];
+    };
+    const std::string path = (std::filesystem::temp_directory_path() / "mapped_vector_test.bin").string();
+    std::filesystem::remove(path);
+    const size_t SIZE = 10000;
+    {
+        MappedVector<Record> v(path, MapMode::READ_WRITE);
+        assert(v.Size() == 0 && !v.IsReadOnly());
+        for (size_t i = 0; i < SIZE; ++i) {
+            Record record{static_cast<int64_t>(i), i * 0.5, {}};
+            std::snprintf(record.name, sizeof(record.name), "rec%zu", i);
+            v.PushBack(record);
+        }
+        // Файл занимает целые страницы, вместимость добирается до конца последней
+        const size_t file_size = std::filesystem::file_size(path);
+        assert(file_size % sysconf(_SC_PAGESIZE) == 0);
+        assert(v.Capacity() >= SIZE);
+        assert(MappedVector<Record>::DATA_OFFSET + (v.Capacity() + 1) * sizeof(Record) > file_size);
+        v.PopBack();
+        v.Flush();
+    }
+    {
+        // Открытие не читает элементы: в кучу ничего не копируется
+        const HeapCounter heap;
+        const MappedVector<Record> v(path);
+        assert(heap.Allocations() == 0);
+        assert(v.IsReadOnly());
+        assert(v.Size() == SIZE - 1);
+        assert(v[1234].id == 1234 && v[1234].value == 617.0);
+        assert(std::string(v[SIZE - 2].name) == "rec" + std::to_string(SIZE - 2));
+        assert(std::all_of(v.begin(), v.end(), [&](const Record& record) {
+            return record.value == record.id * 0.5;
+        }));
+    }
+    {
+        MappedVector<Record> v(path, MapMode::READ_WRITE);
+        assert(v.Size() == SIZE - 1);
+        // Рост через переотображение сохраняет содержимое; аргумент может ссылаться на сам вектор
+        v.Reserve(v.Capacity());
+        const size_t capacity = v.Capacity();
+        v.Resize(capacity);
+        v.PushBack(v[SIZE - 2]);
+        assert(v.Capacity() > capacity);
+        assert(v[capacity].id == static_cast<int64_t>(SIZE - 2));
+        assert(v[SIZE].id == 0 && v[SIZE].value == 0.0);
+
+        v.Resize(10);
+        v.ShrinkToFit();
+        assert(v.Size() == 10 && v[9].id == 9);
+        assert(std::filesystem::file_size(path) == static_cast<uintmax_t>(sysconf(_SC_PAGESIZE)));
+
+        MappedVector<Record> moved(std::move(v));
+        assert(v.Size() == 0);
+        assert(moved.Size() == 10);
+        moved.Clear();
+    }
+    {
+        assert(MappedVector<Record>(path).Size() == 0);
+        // Чужой тип, чужая метка, испорченный заголовок и отсутствующий файл
+        auto expect_error = [&](auto open) {
+            try {
+                open();
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+        };
+        expect_error([&] {
+            MappedVector<int> v(path);
+        });
+        expect_error([&] {
+            MappedVector<Record> v(path, MapMode::READ_ONLY, 42);
+        });
+        {
+            std::FILE* file = std::fopen(path.c_str(), "r+b");
+            std::fputs("garbage", file);
+            std::fclose(file);
+        }
+        expect_error([&] {
+            MappedVector<Record> v(path, MapMode::READ_WRITE);
+        });
+        // Пустой файл отвергается проверкой заголовка, а не падением mmap
+        std::filesystem::resize_file(path, 0);
+        try {
+            MappedVector<Record> v(path);
+            assert(false);
+        } catch (const std::runtime_error& e) {
+            assert(std::string(e.what()).find("file is too small for the header") != std::string::npos);
+        }
+        std::filesystem::remove(path);
+        expect_error([&] {
+            MappedVector<Record> v(path);
+        });
+    }
+    {
+        // Изменения через неконстантный READ_ONLY-вектор отвергаются, а не пишут в защищённые страницы
+        {
+            MappedVector<Record> v(path, MapMode::READ_WRITE);
+            v.PushBack(Record{7, 3.5, "seven"});
+        }
+        MappedVector<Record> v(path);
+        auto expect_rejected = [&](auto mutate) {
+            try {
+                mutate();
+                assert(false);
+            } catch (const std::logic_error&) {
+            }
+        };
+        expect_rejected([&] {
+            v[0].id = 8;
+        });
+        expect_rejected([&] {
+            v.begin();
+        });
+        expect_rejected([&] {
+            v.PushBack(Record{});
+        });
+        expect_rejected([&] {
+            v.PopBack();
+        });
+        expect_rejected([&] {
+            v.Resize(5);
+        });
+        expect_rejected([&] {
+            v.Reserve(1000);
+        });
+        expect_rejected([&] {
+            v.ShrinkToFit();
+        });
+        expect_rejected([&] {
+            v.Clear();
+        });
+        expect_rejected([&] {
+            v.Flush();
+        });
+        const MappedVector<Record>& view = v;
+        assert(view.Size() == 1 && view[0].id == 7 && view.begin()->value == 3.5);
+        std::filesystem::remove(path);
+    }
+}
+
+struct Person {
+    int id = 0;
+    std::string name;
+    Vector<double> scores;
+};
+
+// Пользовательский кодек: поля через кодеки их типов
+template <>
+struct Codec<Person> {
+    template <typename Writer>
+    static void Encode(const Person& person, Writer& out) {
+        Codec<int>::Encode(person.id, out);
+        Codec<std::string>::Encode(person.name, out);
+        Codec<uint64_t>::Encode(person.scores.Size(), out);
+        out.Write(person.scores.begin(), person.scores.Size() * sizeof(double));
+    }
+
+    template <typename Reader>
+    static Person Decode(Reader& in) {
+        Person person;
+        person.id = Codec<int>::Decode(in);
+        person.name = Codec<std::string>::Decode(in);
+        person.scores.ResizeUninitialized(Codec<uint64_t>::Decode(in));
+        in.Read(person.scores.begin(), person.scores.Size() * sizeof(double));
+        return person;
+    }
+};
+
+void Test26() {
+    {
+        // Тривиальный тип: при загрузке единственное выделение — буфер вектора
+        Vector<int64_t> v(3'000'000);
+        std::iota(v.begin(), v.end(), -5);
+        std::stringstream stream;
+        Save(v, stream);
+        assert(stream.str().size() == sizeof(detail::serialization::Header) + v.Size() * sizeof(int64_t));
+        Vector<int64_t> loaded(3);
+        const HeapCounter heap;
+        Load(loaded, stream);
+        assert(heap.Allocations() == 1);
+        assert(std::equal(v.begin(), v.end(), loaded.begin(), loaded.end()));
+    }
+    {
+        // Несколько векторов подряд в одном потоке, включая пустой
+        Vector<std::string> words;
+        for (int i = 0; i < 50'000; ++i) {
+            words.PushBack(std::string(static_cast<size_t>(i % 100), static_cast<char>('a' + i % 26)));
+        }
+        Vector<Person> people;
+        people.PushBack(Person{1, "Ann", Vector<double>(2)});
+        people[0].scores[1] = 2.5;
+        people.PushBack(Person{2, std::string(3'000'000, 'x'), Vector<double>()});
+        people.PushBack(Person{3, "", Vector<double>(200'000)});
+        std::iota(people[2].scores.begin(), people[2].scores.end(), 0.5);
+        std::stringstream stream;
+        Save(words, stream);
+        Save(Vector<int>(), stream);
+        Save(people, stream);
+
+        Vector<std::string> loaded_words;
+        Vector<int> loaded_empty(1);
+        Vector<Person> loaded_people;
+        Load(loaded_words, stream);
+        Load(loaded_empty, stream);
+        Load(loaded_people, stream);
+        assert(stream.peek() == std::char_traits<char>::eof());
+        assert(std::equal(words.begin(), words.end(), loaded_words.begin(), loaded_words.end()));
+        assert(loaded_empty.Size() == 0);
+        assert(loaded_people.Size() == 3);
+        for (size_t i = 0; i < people.Size(); ++i) {
+            assert(loaded_people[i].id == people[i].id);
+            assert(loaded_people[i].name == people[i].name);
+            assert(std::equal(people[i].scores.begin(), people[i].scores.end(), loaded_people[i].scores.begin(),
+                              loaded_people[i].scores.end()));
+        }
+    }
+    {
+        // Через канал: его буфер — десятки килобайт, так что писатель и читатель обязаны идти порциями
+        int fds[2];
+        assert(pipe(fds) == 0);
+        Vector<float> v(5'000'000);
+        std::iota(v.begin(), v.end(), 0.0f);
+        Vector<std::string> names;
+        names.Assign(1000, "name");
+        std::thread writer([&] {
+            Save(v, fds[1]);
+            Save(names, fds[1]);
+            close(fds[1]);
+        });
+        Vector<float> loaded;
+        Vector<std::string> loaded_names;
+        Load(loaded, fds[0]);
+        Load(loaded_names, fds[0]);
+        writer.join();
+        char byte;
+        assert(read(fds[0], &byte, 1) == 0);
+        close(fds[0]);
+        assert(std::equal(v.begin(), v.end(), loaded.begin(), loaded.end()));
+        assert(std::equal(names.begin(), names.end(), loaded_names.begin(), loaded_names.end()));
+    }
+    {
+        // Несовместимые данные отвергаются, а вектор остаётся прежним
+        std::stringstream stream;
+        Save(Vector<int32_t>(10), stream);
+        const std::string bytes = stream.str();
+        auto expect_error = [](const std::string& data, auto target) {
+            std::istringstream in(data);
+            auto before = target;
+            try {
+                Load(target, in);
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(std::equal(before.begin(), before.end(), target.begin(), target.end()));
+        };
+        Vector<std::string> kept;
+        kept.PushBack("kept");
+        expect_error(bytes, Vector<int64_t>(2));
+        expect_error(bytes, kept);
+        expect_error(bytes.substr(0, bytes.size() - 1), Vector<int32_t>(3));
+        expect_error("garbage" + bytes, Vector<int32_t>());
+        // Испорченный счётчик элементов: ошибка формата, а не попытка выделить терабайты
+        std::string huge_count = bytes;
+        const uint64_t count = uint64_t(1) << 40;
+        std::memcpy(huge_count.data() + offsetof(detail::serialization::Header, count), &count, sizeof(count));
+        expect_error(huge_count, Vector<int32_t>(3));
+
+        std::stringstream strings;
+        Save(kept, strings);
+        const std::string encoded = strings.str();
+        expect_error(encoded.substr(0, encoded.size() - 6), kept);
+    }
+    {
+        // Из канала длина данных не известна: вектор растёт по мере чтения и упирается в конец данных
+        int fds[2];
+        assert(pipe(fds) == 0);
+        std::stringstream stream;
+        Save(Vector<int64_t>(1000), stream);
+        std::string bytes = stream.str();
+        const uint64_t count = uint64_t(1) << 40;
+        std::memcpy(bytes.data() + offsetof(detail::serialization::Header, count), &count, sizeof(count));
+        assert(write(fds[1], bytes.data(), bytes.size()) == static_cast<ssize_t>(bytes.size()));
+        close(fds[1]);
+        Vector<int64_t> target;
+        try {
+            Load(target, fds[0]);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        close(fds[0]);
+        assert(target.Size() == 0);
+
+        // У обычного файла длина известна: счётчик отвергается до чтения данных
+        std::FILE* file = std::tmpfile();
+        assert(file != nullptr);
+        const int fd = fileno(file);
+        assert(write(fd, bytes.data(), bytes.size()) == static_cast<ssize_t>(bytes.size()));
+        assert(lseek(fd, 0, SEEK_SET) == 0);
+        try {
+            Load(target, fd);
+            assert(false);
+        } catch (const std::runtime_error& e) {
+            assert(std::string_view(e.what()).find("exceeds") != std::string_view::npos);
+        }
+        std::fclose(file);
+    }
+}
+
+void Test27() {
+    const size_t SIZE = 1000;
+    {
+        SoAVector<int64_t, float, int32_t> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int64_t>(i), static_cast<float>(i) / 2, static_cast<int32_t>(i % 10));
+        }
+        assert(v.Size() == SIZE && v.Capacity() >= SIZE);
+        // Строка — кортеж ссылок: через неё можно и читать, и писать
+        auto [id, price, quantity] = v[7];
+        assert(id == 7 && price == 3.5f && quantity == 7);
+        price = 100.0f;
+        assert(v.Get<1>(7) == 100.0f);
+        v[8] = std::make_tuple(int64_t{-8}, 1.0f, int32_t{-1});
+        assert(v.Get<0>(8) == -8 && v.Get<2>(8) == -1);
+        const SoAVector<int64_t, float, int32_t>::value_type row = v[9];
+        assert(std::get<0>(row) == 9);
+
+        // Колонки — непрерывные массивы, их можно сканировать векторными алгоритмами
+        Span<int32_t> quantities = v.Column<2>();
+        assert(quantities.Size() == SIZE && &quantities[5] == &v.Get<2>(5));
+        assert(Count(quantities, 3) == SIZE / 10);
+        assert(Sum(quantities) == std::accumulate(quantities.begin(), quantities.end(), int64_t{0}));
+        const auto& cv = v;
+        Span<const float> prices = cv.Column<1>();
+        assert(MinMax(prices) == std::make_pair(0.0f, static_cast<float>(SIZE - 1) / 2));
+        assert(Contains(prices, 1.0f) && !Contains(prices, -1.0f));
+        assert(*Find(v.Column<0>(), -8) == -8);
+        Vector<float> cheap;
+        assert(Filter(prices, CompareOp::LESS, 2.0f, cheap) == 5);
+        assert(cheap[3] == 1.5f && cheap[4] == 1.0f);
+
+        size_t rows = 0;
+        for (auto [row_id, row_price, row_quantity] : cv) {
+            assert(row_quantity == static_cast<int32_t>(row_id >= 0 ? row_id % 10 : -1));
+            (void)row_price;
+            ++rows;
+        }
+        assert(rows == SIZE);
+        // Итераторы разных векторов не равны даже на одной позиции
+        const SoAVector<int64_t, float, int32_t> other(SIZE);
+        assert(other.begin() != cv.begin() && other.end() - other.begin() == cv.end() - cv.begin());
+
+        v.Erase(v.begin() + 7, v.begin() + 9);
+        assert(v.Size() == SIZE - 2 && v.Get<0>(7) == 9);
+        v.Erase(v.cbegin());
+        assert(v.Get<0>(0) == 1 && v.Get<1>(0) == 0.5f);
+        v.PopBack();
+        assert(v.Get<0>(v.Size() - 1) == static_cast<int64_t>(SIZE - 2));
+        v.Resize(2);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 2);
+        v.Resize(4);
+        assert(v.Get<0>(3) == 0 && v.Get<1>(3) == 0.0f);
+        // Аргумент ссылается на поле самого вектора, который при этом растёт
+        v.Reserve(v.Size());
+        v.EmplaceBack(v.Get<0>(0), v.Get<1>(0), v.Get<2>(0));
+        assert(v.Get<0>(4) == 1 && v.Get<1>(4) == 0.5f);
+    }
+    {
+        Obj::ResetCounters();
+        {
+            SoAVector<int, Obj, std::string> v;
+            for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+                v.EmplaceBack(i, i, std::to_string(i));
+            }
+            // Obj перемещается при росте, строки не копируются
+            assert(Obj::num_copied == 0);
+            assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE));
+
+            SoAVector<int, Obj, std::string> v_copy(v);
+            assert(Obj::num_copied == static_cast<int>(SIZE));
+            assert(v_copy.Get<2>(SIZE - 1) == std::to_string(SIZE - 1));
+
+            // Исключение из поля откатывает уже построенные поля остальных колонок
+            v.Reserve(v.Size() + 1);
+            Obj bad(-1);
+            bad.throw_on_copy = true;
+            try {
+                v.EmplaceBack(-1, bad, std::string("x"));
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(v.Size() == SIZE);
+            Obj::default_construction_throw_countdown = 10;
+            try {
+                v.Resize(SIZE * 2);
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(v.Size() == SIZE);
+            assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE * 2 + 1));
+
+            const int* first = &v.Get<0>(0);
+            SoAVector<int, Obj, std::string> v_moved(std::move(v));
+            assert(&v_moved.Get<0>(0) == first && v.Size() == 0);
+            v = std::move(v_moved);
+            v_copy.Erase(v_copy.begin(), v_copy.begin() + 10);
+            v.Swap(v_copy);
+            assert(v.Get<1>(0).id == 10 && v_copy.Get<1>(0).id == 0);
+            v = v_copy;
+            assert(v.Size() == SIZE && v.Get<2>(5) == "5");
+            v.PushBack(std::make_tuple(7, Obj(7), std::string("seven")));
+            assert(v.Get<2>(SIZE) == "seven");
+            v.Clear();
+            assert(v.Size() == 0);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void Test28() {
+    const size_t SIZE = 1000;
+    {
+        Vector<int> table(SIZE);
+        std::iota(table.begin(), table.end(), 0);
+        const int* data = table.begin();
+        CowVector<int> v(std::move(table));
+        assert(v.begin() == data && v.UseCount() == 1);
+
+        // Раздача снимков: ни одного обращения к куче
+        std::vector<CowVector<int>> snapshots;
+        snapshots.reserve(100);
+        HeapCounter heap;
+        for (int i = 0; i < 100; ++i) {
+            snapshots.push_back(v);
+        }
+        CowVector<int> assigned;
+        assigned = v;
+        CowVector<int> moved(std::move(assigned));
+        assert(heap.Allocations() == 0);
+        assert(v.UseCount() == 102 && snapshots[5].begin() == data);
+
+        // Первое изменение копирует буфер один раз, снимки его не видят
+        v.PushBack(-1);
+        assert(heap.Allocations() == 2);
+        assert(v.begin() != data && v.Size() == SIZE + 1 && v[SIZE] == -1);
+        assert(snapshots[0].Size() == SIZE && snapshots[0].begin() == data);
+        assert(snapshots[0].UseCount() == 101 && v.UseCount() == 1);
+        v.PushBack(-2);
+        v.Mutable()[0] = 42;
+        assert(heap.Allocations() == 2);
+        assert(snapshots[0][0] == 0);
+
+        // Аргумент из общего буфера переживает его копирование
+        CowVector<int> w = snapshots[1];
+        w.PushBack(w[SIZE - 1]);
+        assert(w[SIZE] == static_cast<int>(SIZE - 1));
+        w = snapshots[1];
+        w.Erase(w.begin() + 1, w.begin() + 11);
+        assert(w.Size() == SIZE - 10 && w[1] == 11 && snapshots[1][1] == 1);
+        w = snapshots[1];
+        w.Insert(w.begin() + 2, w[0]);
+        assert(w[2] == 0 && w[3] == 2 && snapshots[1][2] == 2);
+        w = snapshots[1];
+        w.Resize(10);
+        assert(w.Capacity() == 10);
+        w.PopBack();
+        assert(w.Size() == 9);
+        w = snapshots[1];
+        w.Clear();
+        assert(w.Size() == 0 && w.UseCount() == 0 && snapshots[1].UseCount() == 101);
+        snapshots.clear();
+        assert(moved.UseCount() == 1);
+    }
+    {
+        Obj::ResetCounters();
+        {
+            CowVector<Obj> v(SIZE);
+            CowVector<Obj> copy = v;
+            assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE));
+            copy.EmplaceBack(1);
+            assert(Obj::num_copied == static_cast<int>(SIZE));
+            assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE * 2 + 1));
+            v = copy;
+            assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE + 1));
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Читатели получают снимки из разных потоков, пока писатель меняет свою копию
+        CowVector<int> config(SIZE);
+        std::vector<std::thread> readers;
+        std::atomic<size_t> checked = 0;
+        for (int t = 0; t < 4; ++t) {
+            readers.emplace_back([snapshot = config, &checked] {
+                for (int round = 0; round < 100; ++round) {
+                    CowVector<int> local = snapshot;
+                    assert(std::all_of(local.begin(), local.end(), [](int x) {
+                        return x == 0;
+                    }));
+                    ++checked;
+                }
+            });
+        }
+        for (int round = 0; round < 100; ++round) {
+            CowVector<int> next = config;
+            next.Mutable()[round] = round + 1;
+            config = std::move(next);
+        }
+        for (std::thread& reader : readers) {
+            reader.join();
+        }
+        assert(checked == 400);
+        assert(config[99] == 100 && config.UseCount() == 1);
+    }
+    {
+        // Пустой вектор без блока помнит аллокатор: первая вставка и копии общего буфера идут в ресурс
+        CountingResource resource;
+        {
+            using PmrCow = CowVector<int, std::pmr::polymorphic_allocator<int>>;
+            PmrCow v(&resource);
+            PmrCow from_empty{Vector<int, std::pmr::polymorphic_allocator<int>>(&resource)};
+            assert(resource.num_allocations == 0 && from_empty.GetAllocator().resource() == &resource);
+            v.PushBack(1);
+            from_empty.PushBack(2);
+            // Блок и буфер каждого вектора
+            assert(resource.num_allocations == 4);
+            const PmrCow snapshot = v;
+            v.PushBack(3);
+            assert(resource.num_allocations == 6 && snapshot.Size() == 1);
+            const PmrCow shared = v;
+            v.Clear();
+            v.PushBack(4);
+            assert(resource.num_allocations == 8 && v[0] == 4 && shared.Size() == 2);
+        }
+        assert(resource.bytes_in_use == 0);
+    }
+}
+
+// Дескриптор ресурса: перемещение и деструктор нетривиальны, но объект не хранит своего адреса,
+// поэтому его можно переносить побайтно
+class Handle {
+public:
+    explicit Handle(int value)
+        : value_(new int(value)) {}
+
+    Handle(Handle&& other) noexcept
+        : value_(std::exchange(other.value_, nullptr)) {
+        ++num_moves;
+    }
+
+    Handle& operator=(Handle&& rhs) noexcept {
+        delete std::exchange(value_, std::exchange(rhs.value_, nullptr));
+        ++num_moves;
+        return *this;
+    }
+
+    ~Handle() {
+        delete value_;
+        ++num_destroyed;
+    }
+
+    int Value() const noexcept {
+        return *value_;
+    }
+
+    static inline int num_moves = 0;
+    static inline int num_destroyed = 0;
+
+private:
+    int* value_;
+};
+
+template <>
+struct IsTriviallyRelocatable<Handle> : std::true_type {};
+
+void Test29() {
+    const int SIZE = 1000;
+    static_assert(IsTriviallyRelocatable<int>::value && IsTriviallyRelocatable<std::unique_ptr<int>>::value);
+    static_assert(IsTriviallyRelocatable<std::pair<std::shared_ptr<int>, Vector<std::weak_ptr<int>>>>::value);
+    static_assert(!IsTriviallyRelocatable<std::string>::value && !IsTriviallyRelocatable<Obj>::value);
+    static_assert(!IsTriviallyRelocatable<std::unique_ptr<int, std::function<void(int*)>>>::value);
+    static_assert(RawMemory<std::unique_ptr<int>, ReallocAllocator<std::unique_ptr<int>>>::CAN_REALLOCATE);
+    {
+        // Рост и удаление из середины не вызывают ни перемещений, ни деструкторов
+        Vector<Handle> v;
+        v.Reserve(SIZE);
+        for (int i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(i);
+        }
+        // Вставка в полный вектор: перемещается только сам новый элемент
+        v.Insert(v.begin(), Handle(-1));
+        v.Reserve(SIZE * 4);
+        v.Erase(v.begin() + 10, v.begin() + 20);
+        v.Erase(v.begin() + 1);
+        assert(Handle::num_moves == 1);
+        assert(Handle::num_destroyed == 1 + 10 + 1);
+        assert(v.Size() == static_cast<size_t>(SIZE - 10));
+        assert(v[0].Value() == -1 && v[1].Value() == 1 && v[8].Value() == 8 && v[9].Value() == 19);
+        v.ShrinkToFit();
+        assert(v[v.Size() - 1].Value() == SIZE - 1);
+    }
+    {
+        Vector<std::unique_ptr<int>, ReallocAllocator<std::unique_ptr<int>>> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(std::make_unique<int>(i));
+        }
+        v.Erase(v.begin(), v.begin() + 500);
+        v.ShrinkToFit();
+        assert(v.Size() == 500 && *v[0] == 500 && *v[499] == SIZE - 1);
+    }
+    {
+        auto shared = std::make_shared<int>(7);
+        Vector<std::shared_ptr<int>> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(shared);
+        }
+        v.Erase(v.begin() + 1, v.end());
+        assert(shared.use_count() == 2);
+    }
+    {
+        // Вложенные векторы переезжают вместе со своими буферами
+        Vector<Vector<int>> v;
+        v.EmplaceBack(100);
+        const int* inner = v[0].begin();
+        for (int i = 0; i < SIZE; ++i) {
+            v.EmplaceBack();
+        }
+        assert(v[0].begin() == inner && v[0].Size() == 100);
+
+        SmallVector<std::unique_ptr<int>, 4> small;
+        for (int i = 0; i < 10; ++i) {
+            small.PushBack(std::make_unique<int>(i));
+        }
+        small.Insert(small.begin() + 3, std::make_unique<int>(-1));
+        small.Erase(small.begin());
+        assert(*small[2] == -1 && *small[9] == 9);
+        SmallVector<std::unique_ptr<int>, 4> small_moved(std::move(small));
+        assert(*small_moved[0] == 1);
+
+        SoAVector<std::unique_ptr<int>, std::string, Obj> soa;
+        for (int i = 0; i < SIZE; ++i) {
+            soa.EmplaceBack(std::make_unique<int>(i), std::string(40, 'x'), i);
+        }
+        assert(*soa.Get<0>(SIZE - 1) == SIZE - 1 && soa.Get<2>(SIZE - 1).id == SIZE - 1);
+    }
+    Handle::num_moves = 0;
+    Handle::num_destroyed = 0;
+}
+
+void Test30() {
+    const int SIZE = 1000;
+    {
+        // Вставка без реаллокации сдвигает хвост побайтно: перемещается только временный аргумент
+        Vector<Handle> v;
+        v.Reserve(SIZE + 10);
+        for (int i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(i);
+        }
+        v.Emplace(v.begin() + SIZE / 2, -1);
+        v.Emplace(v.begin(), -2);
+        v.Insert(v.end() - 1, Handle(-3));
+        assert(Handle::num_moves == 1 && Handle::num_destroyed == 1);
+        assert(v.Size() == static_cast<size_t>(SIZE + 3));
+        assert(v[0].Value() == -2 && v[1].Value() == 0 && v[SIZE / 2 + 1].Value() == -1);
+        assert(v[SIZE / 2 + 2].Value() == SIZE / 2 && v[SIZE + 1].Value() == -3 && v[SIZE + 2].Value() == SIZE - 1);
+
+        SmallVector<Handle, 4> small;
+        small.EmplaceBack(1);
+        small.EmplaceBack(2);
+        small.Emplace(small.begin(), 0);
+        assert(Handle::num_moves == 1 && small[0].Value() == 0 && small[2].Value() == 2);
+    }
+    {
+        // Аргумент может ссылаться на элемент, который сдвигается
+        Vector<std::shared_ptr<int>> v;
+        v.Reserve(SIZE);
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(std::make_shared<int>(i));
+        }
+        v.Insert(v.begin(), v[5]);
+        assert(*v[0] == 5 && *v[6] == 5 && v[0].use_count() == 2);
+        v.Insert(v.begin() + 1, 3, v[10]);
+        assert(*v[1] == 9 && *v[3] == 9 && *v[4] == 0 && v[13].use_count() == 4);
+
+        const std::shared_ptr<int> extra[] = {std::make_shared<int>(-1), std::make_shared<int>(-2)};
+        v.Insert(v.begin() + 4, std::begin(extra), std::end(extra));
+        assert(v.Size() == 16 && *v[4] == -1 && *v[5] == -2 && *v[6] == 0 && *v[15] == 9);
+        assert(extra[0].use_count() == 2);
+        v.Erase(v.begin(), v.begin() + 6);
+        assert(v.Size() == 10 && *v[0] == 0 && *v[9] == 9 && extra[0].use_count() == 1);
+    }
+    {
+        // Побайтный сдвиг не требует присваивания: элементы с const-полем тоже вставляются в середину
+        struct Frozen {
+            const int id;
+        };
+        Vector<Frozen> v;
+        v.Reserve(4);
+        v.EmplaceBack(Frozen{1});
+        v.EmplaceBack(Frozen{3});
+        v.Emplace(v.begin() + 1, Frozen{2});
+        v.Emplace(v.begin(), Frozen{0});
+        v.Erase(v.begin() + 1);
+        assert(v.Size() == 3 && v[0].id == 0 && v[1].id == 2 && v[2].id == 3);
+
+        SmallVector<Frozen, 4> small;
+        small.EmplaceBack(Frozen{1});
+        small.Emplace(small.begin(), Frozen{0});
+        small.Erase(small.begin());
+        assert(small.Size() == 1 && small[0].id == 1);
+    }
+    {
+        Vector<int> v;
+        std::vector<int> expected;
+        v.Reserve(SIZE);
+        for (int i = 0; i < SIZE; ++i) {
+            v.Insert(v.begin() + v.Size() / 2, i);
+            expected.insert(expected.begin() + expected.size() / 2, i);
         }
-        Dump();
-    } catch (...) {
+        assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
     }
+    Handle::num_moves = 0;
+    Handle::num_destroyed = 0;
 }
 
 int main() {
@@ -647,7 +2705,30 @@ int main() {
         Test4();
         Test5();
         Test6();
-        Benchmark();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
     }
@@ -0,0 +1,384 @@
+#pragma once
+#include "vector.h"
+
+#include <cerrno>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <typeinfo>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Как открывать файл MappedVector
+enum class MapMode {
+    // Только чтение: файл должен существовать, любая изменяющая операция бросает std::logic_error
+    READ_ONLY,
+    // Чтение и запись: несуществующий файл создаётся пустым
+    READ_WRITE,
+};
+
+namespace detail {
+
+// Метка типа по умолчанию: FNV-1a от декорированного имени типа.
+// Декорирование задаёт ABI платформы, так что метка совпадает у всех сборок одного компилятора
+template <typename T>
+uint64_t DefaultTypeTag() noexcept {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char* c = typeid(T).name(); *c != '\0'; ++c) {
+        hash = (hash ^ static_cast<unsigned char>(*c)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+}  // namespace detail
+
+// Вектор, хранилище которого — отображённый в память файл.
+// В начале файла заголовок (размер, вместимость, размер и метка типа), за ним элементы как есть,
+// в порядке байтов этой машины. Открытие ничего не читает и не копирует: элементы подгружаются
+// страницами при первом обращении, так что загрузка таблицы любого размера — O(1).
+// В режиме READ_WRITE файл растёт через ftruncate и переотображение (mremap), вместимость
+// округляется до целой страницы. Изменения видны другим процессам сразу, а на диск попадают, когда
+// ядро сочтёт нужным; Flush дожидается записи. Размер хранится в самом заголовке, поэтому файл
+// всегда согласован с последней операцией.
+// Переотображение двигает элементы, как реаллокация Vector: указатели на них инвалидируются.
+// Страницы READ_ONLY-файла отображены без права записи, поэтому неконстантный доступ к элементам
+// (operator[], begin, end) у такого вектора тоже бросает std::logic_error: читать нужно через const
+template <typename T, typename GrowthPolicy = DoublingGrowth>
+class MappedVector {
+    static_assert(std::is_trivially_copyable_v<T>, "MappedVector stores elements as raw bytes");
+    static_assert(!detail::REQUIRES_MALLOC_ALLOCATOR<GrowthPolicy>, "MappedVector is not backed by malloc");
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t element_size;
+        uint64_t type_tag;
+        uint64_t size;
+        uint64_t capacity;
+    };
+
+    static constexpr char MAGIC[8] = {'M', 'A', 'P', 'V', 'E', 'C', '0', '1'};
+    static constexpr uint32_t VERSION = 1;
+    // Элементы начинаются с новой кэш-линии (или с alignof(T), если он больше)
+    static constexpr size_t DATA_ALIGNMENT = std::max<size_t>(alignof(T), 64);
+    static constexpr size_t DATA_OFFSET = (sizeof(Header) + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+
+    iterator begin() {
+        CheckWritable();
+        return Data();
+    }
+    iterator end() {
+        CheckWritable();
+        return Data() + Size();
+    }
+    const_iterator begin() const noexcept {
+        return Data();
+    }
+    const_iterator end() const noexcept {
+        return Data() + Size();
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    // type_tag отличает разные типы одного размера; по умолчанию выводится из имени T
+    explicit MappedVector(const std::string& path, MapMode mode = MapMode::READ_ONLY,
+                          uint64_t type_tag = detail::DefaultTypeTag<T>())
+        : read_only_(mode == MapMode::READ_ONLY)
+    {
+        fd_ = open(path.c_str(), read_only_ ? O_RDONLY | O_CLOEXEC : O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            ThrowSystemError("open " + path);
+        }
+        try {
+            struct stat st {};
+            if (fstat(fd_, &st) != 0) {
+                ThrowSystemError("fstat " + path);
+            }
+            if (st.st_size == 0 && !read_only_) {
+                Create(type_tag);
+            } else {
+                // Пустой файл не отображается (mmap нулевой длины — ошибка), его отвергнет Validate
+                if (st.st_size != 0) {
+                    Map(static_cast<size_t>(st.st_size));
+                }
+                Validate(path, type_tag);
+            }
+        } catch (...) {
+            Unmap();
+            close(fd_);
+            throw;
+        }
+    }
+
+    MappedVector(const MappedVector&) = delete;
+    MappedVector& operator=(const MappedVector&) = delete;
+
+    MappedVector(MappedVector&& other) noexcept
+        : fd_(std::exchange(other.fd_, -1))
+        , mapping_(std::exchange(other.mapping_, nullptr))
+        , mapped_bytes_(std::exchange(other.mapped_bytes_, 0))
+        , read_only_(other.read_only_) {}
+
+    MappedVector& operator=(MappedVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Close();
+            fd_ = std::exchange(rhs.fd_, -1);
+            mapping_ = std::exchange(rhs.mapping_, nullptr);
+            mapped_bytes_ = std::exchange(rhs.mapped_bytes_, 0);
+            read_only_ = rhs.read_only_;
+        }
+        return *this;
+    }
+
+    void Swap(MappedVector& other) noexcept {
+        std::swap(fd_, other.fd_);
+        std::swap(mapping_, other.mapping_);
+        std::swap(mapped_bytes_, other.mapped_bytes_);
+        std::swap(read_only_, other.read_only_);
+    }
+
+    // Данные не сбрасываются на диск принудительно: это сделает ядро (или Flush)
+    ~MappedVector() {
+        Close();
+    }
+
+    bool IsReadOnly() const noexcept {
+        return read_only_;
+    }
+
+    // Дожидается записи изменённых страниц на диск
+    void Flush() {
+        CheckWritable();
+        if (msync(mapping_, mapped_bytes_, MS_SYNC) != 0) {
+            ThrowSystemError("msync");
+        }
+    }
+
+    void Reserve(size_t new_capacity) {
+        CheckWritable();
+        if (new_capacity > Capacity()) {
+            Remap(new_capacity);
+        }
+    }
+
+    // Отдаёт файловой системе место сверх размера (с точностью до страницы)
+    void ShrinkToFit() {
+        CheckWritable();
+        if (Capacity() > Size()) {
+            Remap(Size());
+        }
+    }
+
+    // Новые элементы инициализируются значением, как в Vector
+    void Resize(size_t new_size) {
+        CheckWritable();
+        const size_t size = Size();
+        if (new_size > size) {
+            Reserve(new_size);
+            std::uninitialized_value_construct_n(Data() + size, new_size - size);
+        }
+        GetHeader()->size = new_size;
+    }
+
+    void Clear() {
+        CheckWritable();
+        GetHeader()->size = 0;
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        CheckWritable();
+        const size_t size = Size();
+        if (size == Capacity()) {
+            // Элемент строится до переотображения: аргументы могут ссылаться на элементы вектора
+            T value(std::forward<Args>(args)...);
+            Remap(GrowthPolicy::NextCapacity(Capacity(), size + 1, sizeof(T)));
+            new (Data() + size) T(value);
+        } else {
+            new (Data() + size) T(std::forward<Args>(args)...);
+        }
+        GetHeader()->size = size + 1;
+        return Data()[size];
+    }
+
+    template <typename S>
+    void PushBack(S&& value) {
+        EmplaceBack(std::forward<S>(value));
+    }
+
+    void PopBack() {
+        CheckWritable();
+        assert(Size() > 0);
+        --GetHeader()->size;
+    }
+
+    // У перемещённого вектора отображения нет, он считается пустым
+    size_t Size() const noexcept {
+        return mapping_ != nullptr ? GetHeader()->size : 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return mapping_ != nullptr ? GetHeader()->capacity : 0;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        assert(index < Size());
+        return Data()[index];
+    }
+
+    T& operator[](size_t index) {
+        CheckWritable();
+        assert(index < Size());
+        return Data()[index];
+    }
+
+private:
+    static size_t PageSize() noexcept {
+        static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return page_size;
+    }
+
+    // Вместимость, при которой файл занимает целые страницы
+    static size_t FileBytes(size_t& capacity) {
+        if (capacity > (SIZE_MAX - DATA_OFFSET - PageSize()) / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        const size_t page = PageSize();
+        const size_t bytes = (DATA_OFFSET + capacity * sizeof(T) + page - 1) / page * page;
+        capacity = (bytes - DATA_OFFSET) / sizeof(T);
+        return bytes;
+    }
+
+    [[noreturn]] static void ThrowSystemError(const std::string& what) {
+        throw std::system_error(errno, std::generic_category(), "MappedVector: " + what);
+    }
+
+    void CheckWritable() const {
+        if (read_only_) {
+            throw std::logic_error("MappedVector: the file is mapped read-only");
+        }
+    }
+
+    Header* GetHeader() const noexcept {
+        return static_cast<Header*>(mapping_);
+    }
+
+    T* Data() const noexcept {
+        return reinterpret_cast<T*>(static_cast<char*>(mapping_) + DATA_OFFSET);
+    }
+
+    void Create(uint64_t type_tag) {
+        size_t capacity = 0;
+        const size_t bytes = FileBytes(capacity);
+        if (ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+            ThrowSystemError("ftruncate");
+        }
+        Map(bytes);
+        Header* header = GetHeader();
+        std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+        header->version = VERSION;
+        header->element_size = sizeof(T);
+        header->type_tag = type_tag;
+        header->size = 0;
+        header->capacity = capacity;
+    }
+
+    void Map(size_t bytes) {
+        const int protection = read_only_ ? PROT_READ : PROT_READ | PROT_WRITE;
+        void* mapping = mmap(nullptr, bytes, protection, MAP_SHARED, fd_, 0);
+        if (mapping == MAP_FAILED) {
+            ThrowSystemError("mmap");
+        }
+        mapping_ = mapping;
+        mapped_bytes_ = bytes;
+    }
+
+    void Validate(const std::string& path, uint64_t type_tag) const {
+        auto fail = [&](const char* what) {
+            throw std::runtime_error("MappedVector: " + path + ": " + what);
+        };
+        if (mapped_bytes_ < DATA_OFFSET) {
+            fail("file is too small for the header");
+        }
+        const Header* header = GetHeader();
+        if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+            fail("not a MappedVector file");
+        }
+        if (header->version != VERSION) {
+            fail("unsupported format version");
+        }
+        if (header->element_size != sizeof(T) || header->type_tag != type_tag) {
+            fail("element type mismatch");
+        }
+        if (header->size > header->capacity
+            || header->capacity > (mapped_bytes_ - DATA_OFFSET) / sizeof(T)) {
+            fail("size or capacity exceeds the file");
+        }
+    }
+
+    // Меняет размер файла под new_capacity элементов и переотображает его
+    void Remap(size_t new_capacity) {
+        const size_t bytes = FileBytes(new_capacity);
+        const size_t mapped_bytes_before = mapped_bytes_;
+        if (bytes == mapped_bytes_) {
+            GetHeader()->capacity = new_capacity;
+            return;
+        }
+        // Файл растёт до переотображения, а укорачивается после: страницы отображения за концом файла
+        // при обращении дают SIGBUS
+        if (bytes > mapped_bytes_ && ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+            ThrowSystemError("ftruncate");
+        }
+#ifdef __linux__
+        void* mapping = mremap(mapping_, mapped_bytes_, bytes, MREMAP_MAYMOVE);
+        if (mapping == MAP_FAILED) {
+            ThrowSystemError("mremap");
+        }
+        mapping_ = mapping;
+        mapped_bytes_ = bytes;
+#else
+        Unmap();
+        Map(bytes);
+#endif
+        GetHeader()->capacity = new_capacity;
+        // Отображение и заголовок уже новые, так что ошибку укорачивания не сообщаем: файл просто
+        // останется длиннее вместимости, а такой заголовок проверку при открытии проходит
+        if (bytes < mapped_bytes_before) {
+            const int truncated = ftruncate(fd_, static_cast<off_t>(bytes));
+            static_cast<void>(truncated);
+        }
+    }
+
+    void Unmap() noexcept {
+        if (mapping_ != nullptr) {
+            munmap(mapping_, mapped_bytes_);
+            mapping_ = nullptr;
+            mapped_bytes_ = 0;
+        }
+    }
+
+    void Close() noexcept {
+        Unmap();
+        if (fd_ >= 0) {
+            close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    int fd_ = -1;
+    void* mapping_ = nullptr;
+    size_t mapped_bytes_ = 0;
+    bool read_only_ = true;
+};
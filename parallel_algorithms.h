@@ -0,0 +1,214 @@
+#pragma once
+#include "thread_pool.h"
+#include "vector.h"
+
+#include <functional>
+#include <numeric>
+#include <tuple>
+
+// Параллельные алгоритмы над Vector.
+// Диапазон режется на блоки: не меньше MIN_CHUNK_BYTES, чтобы накладные расходы на задачу
+// терялись на фоне работы, и около CHUNKS_PER_THREAD на поток, чтобы кража работы выровняла
+// неравномерную нагрузку. Размер блока кратен кэш-линии, так что соседние блоки при записи
+// делят не больше одной линии. Первый блок выполняет вызывающий поток.
+// Исключение из пользовательской функции пробрасывается после завершения остальных блоков
+
+namespace detail::parallel {
+
+inline constexpr size_t MIN_CHUNK_BYTES = 16 * 1024;
+inline constexpr size_t CHUNKS_PER_THREAD = 4;
+inline constexpr size_t CACHE_LINE = 64;
+
+// Размер блока в элементах
+inline size_t ChunkSize(size_t size, size_t elem_size, size_t concurrency) noexcept {
+    const size_t line = std::max<size_t>(1, CACHE_LINE / elem_size);
+    const size_t min_chunk = std::max(line, MIN_CHUNK_BYTES / elem_size);
+    const size_t num_chunks = concurrency * CHUNKS_PER_THREAD;
+    const size_t chunk = std::max(min_chunk, (size + num_chunks - 1) / num_chunks);
+    return (chunk + line - 1) / line * line;
+}
+
+// Вызывает func(index, begin, end) для каждого блока [begin, end) диапазона [0, size) и ждёт всех
+template <typename Func>
+void ForEachChunk(ThreadPool& pool, size_t size, size_t chunk, Func&& func) {
+    const size_t num_chunks = (size + chunk - 1) / chunk;
+    if (num_chunks <= 1) {
+        if (size > 0) {
+            func(size_t{0}, size_t{0}, size);
+        }
+        return;
+    }
+    TaskGroup group(pool);
+    for (size_t index = 1; index < num_chunks; ++index) {
+        group.Run([&func, index, chunk, size] {
+            func(index, index * chunk, std::min(size, (index + 1) * chunk));
+        });
+    }
+    func(size_t{0}, size_t{0}, chunk);
+    group.Wait();
+}
+
+// Сколько элементов a попадает в первые diagonal элементов устойчивого слияния a и b (merge path).
+// При равенстве первым идёт элемент a, как в std::merge
+template <typename T, typename Compare>
+size_t MergeSplit(const T* a, size_t a_size, const T* b, size_t b_size, size_t diagonal, Compare& comp) {
+    size_t lo = diagonal > b_size ? diagonal - b_size : 0;
+    size_t hi = std::min(diagonal, a_size);
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (comp(b[diagonal - mid - 1], a[mid])) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+}  // namespace detail::parallel
+
+// Вызывает func(element) для каждого элемента
+template <typename T, typename Allocator, typename GrowthPolicy, typename Func>
+void ForEach(ThreadPool& pool, Vector<T, Allocator, GrowthPolicy>& v, Func func) {
+    T* data = v.begin();
+    const size_t chunk = detail::parallel::ChunkSize(v.Size(), sizeof(T), pool.Concurrency());
+    detail::parallel::ForEachChunk(pool, v.Size(), chunk, [&](size_t, size_t begin, size_t end) {
+        std::for_each(data + begin, data + end, func);
+    });
+}
+
+// out[i] = func(in[i]). out получает размер in, старое содержимое перезаписывается.
+// in и out могут быть одним вектором
+template <typename T, typename InAllocator, typename InGrowthPolicy, typename U, typename OutAllocator,
+          typename OutGrowthPolicy, typename Func>
+void Transform(ThreadPool& pool, const Vector<T, InAllocator, InGrowthPolicy>& in,
+               Vector<U, OutAllocator, OutGrowthPolicy>& out, Func func) {
+    const size_t size = in.Size();
+    out.ResizeDefaultInit(size);
+    const T* src = in.begin();
+    U* dest = out.begin();
+    const size_t chunk = detail::parallel::ChunkSize(size, std::max(sizeof(T), sizeof(U)), pool.Concurrency());
+    detail::parallel::ForEachChunk(pool, size, chunk, [&](size_t, size_t begin, size_t end) {
+        std::transform(src + begin, src + end, dest + begin, func);
+    });
+}
+
+// Свёртка init op v[0] op v[1] op ... Операция должна быть ассоциативной: блоки сворачиваются
+// независимо, а их итоги — по порядку. Коммутативность не нужна
+template <typename T, typename Allocator, typename GrowthPolicy, typename U, typename BinaryOp = std::plus<>>
+U Reduce(ThreadPool& pool, const Vector<T, Allocator, GrowthPolicy>& v, U init, BinaryOp op = {}) {
+    const size_t size = v.Size();
+    const T* data = v.begin();
+    const size_t chunk = detail::parallel::ChunkSize(size, sizeof(T), pool.Concurrency());
+    // Итог блока начинается с его первого элемента, так что нейтральный элемент операции не нужен
+    Vector<U> partials;
+    partials.Reserve((size + chunk - 1) / chunk);
+    for (size_t begin = 0; begin < size; begin += chunk) {
+        partials.EmplaceBack(data[begin]);
+    }
+    detail::parallel::ForEachChunk(pool, size, chunk, [&](size_t index, size_t begin, size_t end) {
+        partials[index] = std::accumulate(data + begin + 1, data + end, std::move(partials[index]), op);
+    });
+    for (U& partial : partials) {
+        init = op(std::move(init), std::move(partial));
+    }
+    return init;
+}
+
+// Сортирует блоки параллельно, затем сливает их попарно. Каждый раунд слияния тоже параллелен:
+// выход нарезается на блоки, и для каждого двоичным поиском находится, какие части входов в него попадут.
+// Элементы ходят между v и буфером того же размера, поэтому T должен быть конструируемым по умолчанию.
+// Как и std::sort, неустойчива
+template <typename T, typename Allocator, typename GrowthPolicy, typename Compare = std::less<>>
+void Sort(ThreadPool& pool, Vector<T, Allocator, GrowthPolicy>& v, Compare comp = {}) {
+    const size_t size = v.Size();
+    const size_t chunk = detail::parallel::ChunkSize(size, sizeof(T), pool.Concurrency());
+    if (size <= chunk) {
+        std::sort(v.begin(), v.end(), comp);
+        return;
+    }
+    detail::parallel::ForEachChunk(pool, size, chunk, [&](size_t, size_t begin, size_t end) {
+        std::sort(v.begin() + begin, v.begin() + end, comp);
+    });
+
+    Vector<T, Allocator, GrowthPolicy> buffer(size, DEFAULT_INIT, v.GetAllocator());
+    Vector<T, Allocator, GrowthPolicy>* src = &v;
+    Vector<T, Allocator, GrowthPolicy>* dest = &buffer;
+    // Сколько элементов первого куска пары уходит в начало и в конец каждого блока выхода.
+    // Считаются до слияния: во время слияния соседние блоки уже забирают элементы из src
+    Vector<std::pair<size_t, size_t>> splits((size + chunk - 1) / chunk);
+    for (size_t width = chunk; width < size; width *= 2) {
+        // Пара отсортированных кусков [lo, mid) и [mid, hi) занимает 2 * width, что кратно chunk,
+        // так что каждый блок выхода лежит внутри одной пары
+        auto pair_bounds = [&](size_t begin) {
+            const size_t lo = begin / (2 * width) * (2 * width);
+            return std::make_tuple(lo, std::min(lo + width, size), std::min(lo + 2 * width, size));
+        };
+        detail::parallel::ForEachChunk(pool, size, chunk, [&](size_t index, size_t begin, size_t end) {
+            const auto [lo, mid, hi] = pair_bounds(begin);
+            const T* a = src->begin() + lo;
+            const T* b = src->begin() + mid;
+            splits[index] = {detail::parallel::MergeSplit(a, mid - lo, b, hi - mid, begin - lo, comp),
+                             detail::parallel::MergeSplit(a, mid - lo, b, hi - mid, end - lo, comp)};
+        });
+        detail::parallel::ForEachChunk(pool, size, chunk, [&](size_t index, size_t begin, size_t end) {
+            const auto [lo, mid, hi] = pair_bounds(begin);
+            const auto [a_begin, a_end] = splits[index];
+            T* first = src->begin();
+            std::merge(std::make_move_iterator(first + lo + a_begin), std::make_move_iterator(first + lo + a_end),
+                       std::make_move_iterator(first + mid + (begin - lo - a_begin)),
+                       std::make_move_iterator(first + mid + (end - lo - a_end)), dest->begin() + begin, comp);
+        });
+        std::swap(src, dest);
+    }
+    if (src != &v) {
+        v.Swap(buffer);
+    }
+}
+
+// out[i] = in[0] op in[1] op ... op in[i]. out получает размер in, in и out могут быть одним вектором.
+// Три прохода: итоги блоков параллельно, префиксы итогов последовательно, затем блоки параллельно
+// со своим смещением. Операция должна быть ассоциативной
+template <typename T, typename InAllocator, typename InGrowthPolicy, typename OutAllocator, typename OutGrowthPolicy,
+          typename BinaryOp = std::plus<>>
+void InclusiveScan(ThreadPool& pool, const Vector<T, InAllocator, InGrowthPolicy>& in,
+                   Vector<T, OutAllocator, OutGrowthPolicy>& out, BinaryOp op = {}) {
+    const size_t size = in.Size();
+    const size_t chunk = detail::parallel::ChunkSize(size, sizeof(T), pool.Concurrency());
+    out.ResizeDefaultInit(size);
+    const T* src = in.begin();
+    T* dest = out.begin();
+    if (size <= chunk) {
+        std::partial_sum(src, src + size, dest, op);
+        return;
+    }
+    // Итог первого блока не нужен: он сразу сканируется без смещения
+    Vector<T> offsets;
+    offsets.Reserve((size + chunk - 1) / chunk);
+    for (size_t begin = 0; begin < size; begin += chunk) {
+        offsets.EmplaceBack(src[begin]);
+    }
+    detail::parallel::ForEachChunk(pool, size, chunk, [&](size_t index, size_t begin, size_t end) {
+        if (index == 0) {
+            std::partial_sum(src, src + end, dest, op);
+        } else {
+            offsets[index] = std::accumulate(src + begin + 1, src + end, std::move(offsets[index]), op);
+        }
+    });
+    // offsets[i] превращается в свёртку всех элементов до блока i
+    offsets[0] = dest[chunk - 1];
+    for (size_t index = 1; index + 1 < offsets.Size(); ++index) {
+        offsets[index] = op(offsets[index - 1], offsets[index]);
+    }
+    detail::parallel::ForEachChunk(pool, size - chunk, chunk, [&](size_t index, size_t begin, size_t end) {
+        const T& offset = offsets[index];
+        T* first = dest + chunk + begin;
+        const T* in_first = src + chunk + begin;
+        T acc = op(offset, in_first[0]);
+        first[0] = acc;
+        for (size_t i = 1; i < end - begin; ++i) {
+            acc = op(std::move(acc), in_first[i]);
+            first[i] = acc;
+        }
+    });
+}
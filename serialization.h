@@ -0,0 +1,438 @@
+#pragma once
+#include "vector.h"
+
+#include <cerrno>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Сохранение Vector в файловый дескриптор или поток и загрузка обратно.
+// Формат: заголовок (версия, порядок байтов, размер и выравнивание элемента, число элементов), затем данные.
+// Тривиально копируемые T пишутся байтами прямо из буфера вектора и читаются прямо в него:
+// ни промежуточных копий, ни работы на элемент. Остальные T кодируются поэлементно через Codec<T>
+// и идут кадрами не больше CHUNK_BYTES с длиной впереди, так что память под передачу ограничена
+// одним кадром, а чтение никогда не заходит за конец вектора: в одном потоке можно держать несколько подряд
+
+namespace detail::serialization {
+
+inline constexpr char MAGIC[8] = {'V', 'E', 'C', 'T', 'O', 'R', 'S', 'V'};
+inline constexpr uint32_t VERSION = 1;
+// Записывается как есть: на машине с другим порядком байтов читается переставленным
+inline constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+// Сколько байт передаётся за раз и наибольший кадр поэлементной кодировки
+inline constexpr size_t CHUNK_BYTES = size_t(1) << 20;
+
+enum class Encoding : uint32_t {
+    // count * element_size байт подряд
+    RAW = 0,
+    // Кадры: uint32_t длина, затем столько байт закодированных элементов; кадр нулевой длины завершает
+    CODEC = 1,
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t element_size;
+    uint32_t element_alignment;
+    Encoding encoding;
+    uint32_t reserved;
+    uint64_t count;
+};
+
+[[noreturn]] inline void ThrowFormatError(const char* what) {
+    throw std::runtime_error(std::string("Vector serialization: ") + what);
+}
+
+class FdWriter {
+public:
+    explicit FdWriter(int fd) noexcept
+        : fd_(fd) {}
+
+    // write может записать меньше запрошенного (канал, сокет) — дописываем остаток
+    void Write(const void* data, size_t bytes) {
+        const char* ptr = static_cast<const char*>(data);
+        while (bytes > 0) {
+            const ssize_t written = write(fd_, ptr, std::min(bytes, CHUNK_BYTES));
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "Vector serialization: write");
+            }
+            ptr += written;
+            bytes -= static_cast<size_t>(written);
+        }
+    }
+
+private:
+    int fd_;
+};
+
+class FdReader {
+public:
+    explicit FdReader(int fd) noexcept
+        : fd_(fd) {}
+
+    void Read(void* data, size_t bytes) {
+        char* ptr = static_cast<char*>(data);
+        while (bytes > 0) {
+            const ssize_t received = read(fd_, ptr, std::min(bytes, CHUNK_BYTES));
+            if (received < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "Vector serialization: read");
+            }
+            if (received == 0) {
+                ThrowFormatError("unexpected end of data");
+            }
+            ptr += received;
+            bytes -= static_cast<size_t>(received);
+        }
+    }
+
+    // Сколько байт осталось до конца обычного файла; у канала или сокета — SIZE_MAX (не известно)
+    size_t RemainingBytes() const noexcept {
+        struct stat st {};
+        if (fstat(fd_, &st) != 0 || !S_ISREG(st.st_mode)) {
+            return SIZE_MAX;
+        }
+        const off_t pos = lseek(fd_, 0, SEEK_CUR);
+        if (pos < 0) {
+            return SIZE_MAX;
+        }
+        return pos < st.st_size ? static_cast<size_t>(st.st_size - pos) : 0;
+    }
+
+private:
+    int fd_;
+};
+
+class StreamWriter {
+public:
+    explicit StreamWriter(std::ostream& out) noexcept
+        : out_(out) {}
+
+    void Write(const void* data, size_t bytes) {
+        const char* ptr = static_cast<const char*>(data);
+        while (bytes > 0) {
+            const size_t chunk = std::min(bytes, CHUNK_BYTES);
+            if (!out_.write(ptr, static_cast<std::streamsize>(chunk))) {
+                ThrowFormatError("stream write failed");
+            }
+            ptr += chunk;
+            bytes -= chunk;
+        }
+    }
+
+private:
+    std::ostream& out_;
+};
+
+class StreamReader {
+public:
+    explicit StreamReader(std::istream& in) noexcept
+        : in_(in) {}
+
+    void Read(void* data, size_t bytes) {
+        char* ptr = static_cast<char*>(data);
+        while (bytes > 0) {
+            const size_t chunk = std::min(bytes, CHUNK_BYTES);
+            if (!in_.read(ptr, static_cast<std::streamsize>(chunk))) {
+                ThrowFormatError("unexpected end of data");
+            }
+            ptr += chunk;
+            bytes -= chunk;
+        }
+    }
+
+    // Сколько байт осталось в потоке с позиционированием (файл, строка); иначе SIZE_MAX (не известно)
+    size_t RemainingBytes() {
+        const std::streampos pos = in_.tellg();
+        if (pos == std::streampos(-1)) {
+            return SIZE_MAX;
+        }
+        const std::ios::iostate state = in_.rdstate();
+        in_.seekg(0, std::ios::end);
+        const std::streampos end = in_.tellg();
+        in_.clear(state);
+        in_.seekg(pos);
+        if (end == std::streampos(-1) || end < pos) {
+            return SIZE_MAX;
+        }
+        return static_cast<size_t>(end - pos);
+    }
+
+private:
+    std::istream& in_;
+};
+
+// Копит закодированные элементы и отправляет их кадрами. Элемент может оказаться в двух кадрах
+template <typename Sink>
+class FrameWriter {
+public:
+    explicit FrameWriter(Sink& sink)
+        : sink_(sink)
+        , buffer_(CHUNK_BYTES, DEFAULT_INIT) {}
+
+    void Write(const void* data, size_t bytes) {
+        const char* ptr = static_cast<const char*>(data);
+        while (bytes > 0) {
+            const size_t chunk = std::min(bytes, CHUNK_BYTES - used_);
+            std::memcpy(buffer_.begin() + used_, ptr, chunk);
+            used_ += chunk;
+            ptr += chunk;
+            bytes -= chunk;
+            if (used_ == CHUNK_BYTES) {
+                Flush();
+            }
+        }
+    }
+
+    // Отправляет накопленное и кадр-терминатор
+    void Finish() {
+        Flush();
+        const uint32_t end = 0;
+        sink_.Write(&end, sizeof(end));
+    }
+
+private:
+    void Flush() {
+        if (used_ == 0) {
+            return;
+        }
+        const auto length = static_cast<uint32_t>(used_);
+        sink_.Write(&length, sizeof(length));
+        sink_.Write(buffer_.begin(), used_);
+        used_ = 0;
+    }
+
+    Sink& sink_;
+    Vector<char> buffer_;
+    size_t used_ = 0;
+};
+
+// Читает кадры по одному, не заглядывая за кадр-терминатор
+template <typename Source>
+class FrameReader {
+public:
+    explicit FrameReader(Source& source)
+        : source_(source)
+        , buffer_(CHUNK_BYTES, DEFAULT_INIT) {}
+
+    void Read(void* data, size_t bytes) {
+        char* ptr = static_cast<char*>(data);
+        while (bytes > 0) {
+            if (position_ == length_) {
+                NextFrame();
+                if (length_ == 0) {
+                    ThrowFormatError("element crosses the end of data");
+                }
+            }
+            const size_t chunk = std::min(bytes, length_ - position_);
+            std::memcpy(ptr, buffer_.begin() + position_, chunk);
+            position_ += chunk;
+            ptr += chunk;
+            bytes -= chunk;
+        }
+    }
+
+    // Все элементы прочитаны: дальше должен идти терминатор
+    void Finish() {
+        if (position_ != length_) {
+            ThrowFormatError("trailing data after the last element");
+        }
+        NextFrame();
+        if (length_ != 0) {
+            ThrowFormatError("trailing data after the last element");
+        }
+    }
+
+private:
+    void NextFrame() {
+        uint32_t length = 0;
+        source_.Read(&length, sizeof(length));
+        if (length > CHUNK_BYTES) {
+            ThrowFormatError("frame is too large");
+        }
+        source_.Read(buffer_.begin(), length);
+        length_ = length;
+        position_ = 0;
+    }
+
+    Source& source_;
+    Vector<char> buffer_;
+    size_t length_ = 0;
+    size_t position_ = 0;
+};
+
+}  // namespace detail::serialization
+
+// Поэлементный кодек. Для своих типов специализируйте Codec<T> с двумя функциями:
+//     template <typename Writer> static void Encode(const T& value, Writer& out);  // out.Write(data, bytes)
+//     template <typename Reader> static T Decode(Reader& in);                      // in.Read(data, bytes)
+// Кодеки полей можно вызывать изнутри: Codec<int>::Encode(value.id, out)
+template <typename T, typename = void>
+struct Codec;
+
+// Тривиально копируемое значение — его байты
+template <typename T>
+struct Codec<T, std::enable_if_t<std::is_trivially_copyable_v<T>>> {
+    template <typename Writer>
+    static void Encode(const T& value, Writer& out) {
+        out.Write(&value, sizeof(T));
+    }
+
+    template <typename Reader>
+    static T Decode(Reader& in) {
+        T value;
+        in.Read(&value, sizeof(T));
+        return value;
+    }
+};
+
+// Строка — длина и символы
+template <>
+struct Codec<std::string> {
+    template <typename Writer>
+    static void Encode(const std::string& value, Writer& out) {
+        const uint64_t length = value.size();
+        out.Write(&length, sizeof(length));
+        out.Write(value.data(), value.size());
+    }
+
+    template <typename Reader>
+    static std::string Decode(Reader& in) {
+        uint64_t length = 0;
+        in.Read(&length, sizeof(length));
+        std::string value;
+        // Читаем кусками: испорченная длина не должна сразу выделить гигабайты
+        while (value.size() < length) {
+            const size_t old_size = value.size();
+            const size_t chunk = std::min<uint64_t>(length - old_size, detail::serialization::CHUNK_BYTES);
+            value.resize(old_size + chunk);
+            in.Read(value.data() + old_size, chunk);
+        }
+        return value;
+    }
+};
+
+namespace detail::serialization {
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename Sink>
+void SaveTo(const Vector<T, Allocator, GrowthPolicy>& v, Sink& sink) {
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.element_size = sizeof(T);
+    header.element_alignment = alignof(T);
+    header.encoding = std::is_trivially_copyable_v<T> ? Encoding::RAW : Encoding::CODEC;
+    header.count = v.Size();
+    sink.Write(&header, sizeof(header));
+
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        sink.Write(v.begin(), v.Size() * sizeof(T));
+    } else {
+        FrameWriter<Sink> frames(sink);
+        for (const T& value : v) {
+            Codec<T>::Encode(value, frames);
+        }
+        frames.Finish();
+    }
+}
+
+// Загружает во временный вектор и только потом подменяет содержимое v: при ошибке v не меняется
+template <typename T, typename Allocator, typename GrowthPolicy, typename Source>
+void LoadFrom(Vector<T, Allocator, GrowthPolicy>& v, Source& source) {
+    Header header{};
+    source.Read(&header, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        ThrowFormatError("not a serialized Vector");
+    }
+    if (header.byte_order != BYTE_ORDER_MARK) {
+        ThrowFormatError("byte order mismatch");
+    }
+    if (header.version != VERSION) {
+        ThrowFormatError("unsupported format version");
+    }
+    constexpr Encoding ENCODING = std::is_trivially_copyable_v<T> ? Encoding::RAW : Encoding::CODEC;
+    if (header.encoding != ENCODING) {
+        ThrowFormatError("encoding mismatch");
+    }
+    if (ENCODING == Encoding::RAW
+        && (header.element_size != sizeof(T) || header.element_alignment != alignof(T))) {
+        ThrowFormatError("element layout mismatch");
+    }
+    if (header.count > SIZE_MAX / sizeof(T)) {
+        ThrowFormatError("element count is too large");
+    }
+    const auto count = static_cast<size_t>(header.count);
+
+    Vector<T, Allocator, GrowthPolicy> loaded(v.GetAllocator());
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        // Байты читаются прямо в буфер вектора. Если у T тривиальный конструктор по умолчанию,
+        // ResizeDefaultInit память не трогает.
+        // Когда длина данных известна, счётчик сверяется с ней и буфер выделяется один раз.
+        // Иначе первым выделяется один кадр, а дальше вместимость удваивается по мере чтения:
+        // испорченный счётчик упрётся в конец данных, а не выделит гигабайты заранее
+        const size_t remaining = source.RemainingBytes();
+        if (remaining != SIZE_MAX && count > remaining / sizeof(T)) {
+            ThrowFormatError("element count exceeds the data");
+        }
+        const size_t chunk_elements = std::max<size_t>(1, CHUNK_BYTES / sizeof(T));
+        loaded.Reserve(remaining != SIZE_MAX ? count : std::min(count, chunk_elements));
+        while (loaded.Size() < count) {
+            const size_t old_size = loaded.Size();
+            const size_t chunk = std::min(count - old_size, chunk_elements);
+            if (old_size + chunk > loaded.Capacity()) {
+                loaded.Reserve(std::min(count, std::max(old_size + chunk, loaded.Capacity() * 2)));
+            }
+            loaded.ResizeDefaultInit(old_size + chunk);
+            source.Read(loaded.begin() + old_size, chunk * sizeof(T));
+        }
+    } else {
+        // Сколько элементов влезет, заранее не известно: вместимость растёт вместе с прочитанным,
+        // чтобы испорченный счётчик не выделил лишнего
+        FrameReader<Source> frames(source);
+        for (size_t i = 0; i < count; ++i) {
+            loaded.EmplaceBack(Codec<T>::Decode(frames));
+        }
+        frames.Finish();
+    }
+    v.Swap(loaded);
+}
+
+}  // namespace detail::serialization
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Save(const Vector<T, Allocator, GrowthPolicy>& v, int fd) {
+    detail::serialization::FdWriter sink(fd);
+    detail::serialization::SaveTo(v, sink);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Save(const Vector<T, Allocator, GrowthPolicy>& v, std::ostream& out) {
+    detail::serialization::StreamWriter sink(out);
+    detail::serialization::SaveTo(v, sink);
+}
+
+// Заменяет содержимое v прочитанным. Читает ровно сохранённое, так что следующий Load с того же
+// дескриптора или потока получит следующий вектор
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Load(Vector<T, Allocator, GrowthPolicy>& v, int fd) {
+    detail::serialization::FdReader source(fd);
+    detail::serialization::LoadFrom(v, source);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Load(Vector<T, Allocator, GrowthPolicy>& v, std::istream& in) {
+    detail::serialization::StreamReader source(in);
+    detail::serialization::LoadFrom(v, source);
+}
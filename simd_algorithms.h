@@ -0,0 +1,579 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <limits>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define VECTOR_SIMD_X86 1
+#endif
+
+// Векторизованные поиск, подсчёт, свёртки и фильтрация для Vector<int32_t> и Vector<float>.
+// Ядра написаны один раз на векторных расширениях GCC/Clang и собираются под SSE2, AVX2 и AVX-512;
+// нужный вариант выбирается во время выполнения по возможностям процессора.
+// Для остальных арифметических T, других компиляторов и архитектур работает скалярный код
+
+// Набор инструкций, которым пользуются функции ниже
+enum class SimdLevel {
+    SCALAR,
+    SSE2,
+    AVX2,
+    AVX512,
+};
+
+// Условие отбора для Filter
+enum class CompareOp {
+    LESS,
+    LESS_EQUAL,
+    EQUAL,
+    NOT_EQUAL,
+    GREATER_EQUAL,
+    GREATER,
+};
+
+namespace detail::simd {
+
+// Сумма целых считается в 64 битах, чтобы не переполниться; сумма вещественных — в самом T
+template <typename T>
+using SumType = std::conditional_t<std::is_floating_point_v<T>, T,
+                                   std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+template <typename T>
+inline constexpr bool IS_VECTORIZED = std::is_same_v<T, int32_t> || std::is_same_v<T, float>;
+
+template <CompareOp Op, typename T>
+bool Compare(T lhs, T rhs) noexcept {
+    if constexpr (Op == CompareOp::LESS) {
+        return lhs < rhs;
+    } else if constexpr (Op == CompareOp::LESS_EQUAL) {
+        return lhs <= rhs;
+    } else if constexpr (Op == CompareOp::EQUAL) {
+        return lhs == rhs;
+    } else if constexpr (Op == CompareOp::NOT_EQUAL) {
+        return lhs != rhs;
+    } else if constexpr (Op == CompareOp::GREATER_EQUAL) {
+        return lhs >= rhs;
+    } else {
+        return lhs > rhs;
+    }
+}
+
+// Вызывает func с Op, известным на этапе компиляции: ветвление один раз на весь проход, а не на элемент
+template <typename Func>
+decltype(auto) WithCompareOp(CompareOp op, Func&& func) {
+    switch (op) {
+        case CompareOp::LESS:
+            return func(std::integral_constant<CompareOp, CompareOp::LESS>{});
+        case CompareOp::LESS_EQUAL:
+            return func(std::integral_constant<CompareOp, CompareOp::LESS_EQUAL>{});
+        case CompareOp::EQUAL:
+            return func(std::integral_constant<CompareOp, CompareOp::EQUAL>{});
+        case CompareOp::NOT_EQUAL:
+            return func(std::integral_constant<CompareOp, CompareOp::NOT_EQUAL>{});
+        case CompareOp::GREATER_EQUAL:
+            return func(std::integral_constant<CompareOp, CompareOp::GREATER_EQUAL>{});
+        case CompareOp::GREATER:
+            break;
+    }
+    return func(std::integral_constant<CompareOp, CompareOp::GREATER>{});
+}
+
+// Скалярные версии: запасной путь и эталон для тестов
+
+template <typename T>
+size_t FindScalar(const T* data, size_t size, T value) noexcept {
+    return static_cast<size_t>(std::find(data, data + size, value) - data);
+}
+
+template <typename T>
+size_t CountScalar(const T* data, size_t size, T value) noexcept {
+    size_t count = 0;
+    for (size_t i = 0; i < size; ++i) {
+        count += data[i] == value ? 1 : 0;
+    }
+    return count;
+}
+
+template <typename T>
+SumType<T> SumScalar(const T* data, size_t size) noexcept {
+    SumType<T> sum = 0;
+    for (size_t i = 0; i < size; ++i) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+template <typename T>
+std::pair<T, T> MinMaxScalar(const T* data, size_t size) noexcept {
+    T lo = data[0];
+    T hi = data[0];
+    for (size_t i = 1; i < size; ++i) {
+        lo = data[i] < lo ? data[i] : lo;
+        hi = data[i] > hi ? data[i] : hi;
+    }
+    return {lo, hi};
+}
+
+// Каждый элемент пишется на место out, а out сдвигается, только если элемент прошёл отбор (как в EraseIf)
+template <CompareOp Op, typename T>
+size_t FilterScalar(const T* data, size_t size, T threshold, T* out) noexcept {
+    size_t count = 0;
+    for (size_t i = 0; i < size; ++i) {
+        out[count] = data[i];
+        count += Compare<Op>(data[i], threshold) ? 1 : 0;
+    }
+    return count;
+}
+
+#ifdef VECTOR_SIMD_X86
+
+// Регистр из Bytes байт, составленный из элементов T
+template <typename T, size_t Bytes>
+struct Lanes {
+    static constexpr size_t COUNT = Bytes / sizeof(T);
+    typedef T Vec __attribute__((vector_size(Bytes)));
+    // Половина регистра: целые расширяются до 64 бит по половинкам, чтобы не выйти за ширину регистра
+    typedef T Half __attribute__((vector_size(Bytes / 2)));
+    typedef int64_t Wide __attribute__((vector_size(Bytes)));
+    // Результат сравнения: -1 в дорожках, где условие выполнено, 0 в остальных
+    using Mask = decltype(Vec{} == Vec{});
+};
+
+// Ядра ниже встраиваются в функции с нужным target и компилируются под их набор инструкций.
+// Сами они target не задают: GCC не встраивает функции с более широким набором в более узкий.
+// Векторы между ними передаются по ссылке: по значению GCC предупреждает о смене ABI без AVX
+
+template <typename Vec, typename T>
+__attribute__((always_inline)) inline void Load(Vec& vec, const T* data) noexcept {
+    std::memcpy(&vec, data, sizeof(vec));
+}
+
+template <CompareOp Op, typename Vec, typename Mask>
+__attribute__((always_inline)) inline void CompareLanes(const Vec& lhs, const Vec& rhs, Mask& mask) noexcept {
+    if constexpr (Op == CompareOp::LESS) {
+        mask = lhs < rhs;
+    } else if constexpr (Op == CompareOp::LESS_EQUAL) {
+        mask = lhs <= rhs;
+    } else if constexpr (Op == CompareOp::EQUAL) {
+        mask = lhs == rhs;
+    } else if constexpr (Op == CompareOp::NOT_EQUAL) {
+        mask = lhs != rhs;
+    } else if constexpr (Op == CompareOp::GREATER_EQUAL) {
+        mask = lhs >= rhs;
+    } else {
+        mask = lhs > rhs;
+    }
+}
+
+// Сравнение даёт -1 в совпавших дорожках, вычитая маски, копим счётчики по дорожкам.
+// Блок ограничен, чтобы 32-битные счётчики не переполнились
+template <typename T, size_t Bytes>
+__attribute__((always_inline)) inline size_t CountKernel(const T* data, size_t size, T value) noexcept {
+    using Vec = typename Lanes<T, Bytes>::Vec;
+    constexpr size_t LANES = Lanes<T, Bytes>::COUNT;
+    constexpr size_t BLOCK = LANES << 20;
+    const Vec needle = Vec{} + value;
+    size_t count = 0;
+    size_t i = 0;
+    while (i + LANES <= size) {
+        typename Lanes<T, Bytes>::Mask matches{};
+        const size_t block_end = i + std::min(BLOCK, (size - i) / LANES * LANES);
+        for (; i < block_end; i += LANES) {
+            Vec x;
+            Load(x, data + i);
+            matches -= x == needle;
+        }
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            count += static_cast<size_t>(matches[lane]);
+        }
+    }
+    return count + CountScalar(data + i, size - i, value);
+}
+
+// Блоки по CHUNK элементов проверяются подсчётом, первый блок с совпадением досматривается скалярно
+template <typename T, size_t Bytes>
+__attribute__((always_inline)) inline size_t FindKernel(const T* data, size_t size, T value) noexcept {
+    constexpr size_t CHUNK = 256;
+    size_t i = 0;
+    for (; i + CHUNK <= size; i += CHUNK) {
+        if (CountKernel<T, Bytes>(data + i, CHUNK, value) != 0) {
+            return i + FindScalar(data + i, CHUNK, value);
+        }
+    }
+    return i + FindScalar(data + i, size - i, value);
+}
+
+template <typename T, size_t Bytes>
+__attribute__((always_inline)) inline SumType<T> SumKernel(const T* data, size_t size) noexcept {
+    using L = Lanes<T, Bytes>;
+    constexpr size_t LANES = L::COUNT;
+    size_t i = 0;
+    SumType<T> sum = 0;
+    if constexpr (std::is_integral_v<T>) {
+        typename L::Wide low{};
+        typename L::Wide high{};
+        for (; i + LANES <= size; i += LANES) {
+            typename L::Half half;
+            std::memcpy(&half, data + i, sizeof(half));
+            low += __builtin_convertvector(half, typename L::Wide);
+            std::memcpy(&half, data + i + LANES / 2, sizeof(half));
+            high += __builtin_convertvector(half, typename L::Wide);
+        }
+        low += high;
+        for (size_t lane = 0; lane < LANES / 2; ++lane) {
+            sum += low[lane];
+        }
+    } else {
+        // Два аккумулятора, чтобы сложения не ждали друг друга
+        typename L::Vec acc0{};
+        typename L::Vec acc1{};
+        for (; i + 2 * LANES <= size; i += 2 * LANES) {
+            typename L::Vec x0;
+            typename L::Vec x1;
+            Load(x0, data + i);
+            Load(x1, data + i + LANES);
+            acc0 += x0;
+            acc1 += x1;
+        }
+        acc0 += acc1;
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            sum += acc0[lane];
+        }
+    }
+    return sum + SumScalar(data + i, size - i);
+}
+
+template <typename T, size_t Bytes>
+__attribute__((always_inline)) inline std::pair<T, T> MinMaxKernel(const T* data, size_t size) noexcept {
+    using Vec = typename Lanes<T, Bytes>::Vec;
+    constexpr size_t LANES = Lanes<T, Bytes>::COUNT;
+    if (size < LANES) {
+        return MinMaxScalar(data, size);
+    }
+    Vec lo;
+    Load(lo, data);
+    Vec hi = lo;
+    size_t i = LANES;
+    for (; i + LANES <= size; i += LANES) {
+        Vec x;
+        Load(x, data + i);
+        lo = x < lo ? x : lo;
+        hi = x > hi ? x : hi;
+    }
+    std::pair<T, T> result = MinMaxScalar(data + i - LANES, size - i + LANES);
+    for (size_t lane = 0; lane < LANES; ++lane) {
+        result.first = lo[lane] < result.first ? lo[lane] : result.first;
+        result.second = hi[lane] > result.second ? hi[lane] : result.second;
+    }
+    return result;
+}
+
+// Для AVX2: перестановка, сдвигающая отобранные дорожки (биты маски) в начало регистра
+struct CompressTable {
+    alignas(32) int32_t indices[256][8];
+};
+
+constexpr CompressTable MakeCompressTable() noexcept {
+    CompressTable table{};
+    for (int mask = 0; mask < 256; ++mask) {
+        int count = 0;
+        for (int lane = 0; lane < 8; ++lane) {
+            if ((mask >> lane) & 1) {
+                table.indices[mask][count++] = lane;
+            }
+        }
+    }
+    return table;
+}
+
+inline constexpr CompressTable COMPRESS_TABLE = MakeCompressTable();
+
+// SSE2 входит в базовый x86-64, отдельный target не нужен
+
+template <typename T>
+size_t FindSse2(const T* data, size_t size, T value) noexcept {
+    return FindKernel<T, 16>(data, size, value);
+}
+template <typename T>
+size_t CountSse2(const T* data, size_t size, T value) noexcept {
+    return CountKernel<T, 16>(data, size, value);
+}
+template <typename T>
+SumType<T> SumSse2(const T* data, size_t size) noexcept {
+    return SumKernel<T, 16>(data, size);
+}
+template <typename T>
+std::pair<T, T> MinMaxSse2(const T* data, size_t size) noexcept {
+    return MinMaxKernel<T, 16>(data, size);
+}
+
+// В SSE2 нет перестановки дорожек по маске (pshufb появился в SSSE3), а разбор маски по дорожкам
+// медленнее скалярного цикла без ветвлений
+template <CompareOp Op, typename T>
+size_t FilterSse2(const T* data, size_t size, T threshold, T* out) noexcept {
+    return FilterScalar<Op>(data, size, threshold, out);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) size_t FindAvx2(const T* data, size_t size, T value) noexcept {
+    return FindKernel<T, 32>(data, size, value);
+}
+template <typename T>
+__attribute__((target("avx2"))) size_t CountAvx2(const T* data, size_t size, T value) noexcept {
+    return CountKernel<T, 32>(data, size, value);
+}
+template <typename T>
+__attribute__((target("avx2"))) SumType<T> SumAvx2(const T* data, size_t size) noexcept {
+    return SumKernel<T, 32>(data, size);
+}
+template <typename T>
+__attribute__((target("avx2"))) std::pair<T, T> MinMaxAvx2(const T* data, size_t size) noexcept {
+    return MinMaxKernel<T, 32>(data, size);
+}
+
+// Отобранные дорожки сдвигаются в начало регистра одной перестановкой и пишутся целым регистром:
+// лишние дорожки затрутся следующей записью. out вмещает size элементов, а count <= i,
+// так что запись не выходит за край
+template <CompareOp Op, typename T>
+__attribute__((target("avx2"))) size_t FilterAvx2(const T* data, size_t size, T threshold, T* out) noexcept {
+    using Vec = typename Lanes<T, 32>::Vec;
+    const Vec bound = Vec{} + threshold;
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        Vec x;
+        Load(x, data + i);
+        typename Lanes<T, 32>::Mask mask;
+        CompareLanes<Op>(x, bound, mask);
+        const int bits = _mm256_movemask_ps(reinterpret_cast<__m256>(mask));
+        const __m256i indices = _mm256_load_si256(reinterpret_cast<const __m256i*>(COMPRESS_TABLE.indices[bits]));
+        const __m256i packed = _mm256_permutevar8x32_epi32(reinterpret_cast<__m256i>(x), indices);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + count), packed);
+        count += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(bits)));
+    }
+    return count + FilterScalar<Op>(data + i, size - i, threshold, out + count);
+}
+
+template <typename T>
+__attribute__((target("avx512f"))) size_t FindAvx512(const T* data, size_t size, T value) noexcept {
+    return FindKernel<T, 64>(data, size, value);
+}
+template <typename T>
+__attribute__((target("avx512f"))) size_t CountAvx512(const T* data, size_t size, T value) noexcept {
+    return CountKernel<T, 64>(data, size, value);
+}
+template <typename T>
+__attribute__((target("avx512f"))) SumType<T> SumAvx512(const T* data, size_t size) noexcept {
+    return SumKernel<T, 64>(data, size);
+}
+template <typename T>
+__attribute__((target("avx512f"))) std::pair<T, T> MinMaxAvx512(const T* data, size_t size) noexcept {
+    return MinMaxKernel<T, 64>(data, size);
+}
+
+// В AVX-512 уплотнение — одна инструкция (vpcompressd/vcompressps) по маске сравнения
+template <CompareOp Op, typename T>
+__attribute__((target("avx512f"))) size_t FilterAvx512(const T* data, size_t size, T threshold, T* out) noexcept {
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __mmask16 mask;
+        if constexpr (std::is_same_v<T, float>) {
+            constexpr int PREDICATE = Op == CompareOp::LESS            ? _CMP_LT_OQ
+                                      : Op == CompareOp::LESS_EQUAL    ? _CMP_LE_OQ
+                                      : Op == CompareOp::EQUAL         ? _CMP_EQ_OQ
+                                      : Op == CompareOp::NOT_EQUAL     ? _CMP_NEQ_UQ
+                                      : Op == CompareOp::GREATER_EQUAL ? _CMP_GE_OQ
+                                                                       : _CMP_GT_OQ;
+            const __m512 x = _mm512_loadu_ps(data + i);
+            mask = _mm512_cmp_ps_mask(x, _mm512_set1_ps(threshold), PREDICATE);
+            _mm512_mask_compressstoreu_ps(out + count, mask, x);
+        } else {
+            constexpr int PREDICATE = Op == CompareOp::LESS            ? _MM_CMPINT_LT
+                                      : Op == CompareOp::LESS_EQUAL    ? _MM_CMPINT_LE
+                                      : Op == CompareOp::EQUAL         ? _MM_CMPINT_EQ
+                                      : Op == CompareOp::NOT_EQUAL     ? _MM_CMPINT_NE
+                                      : Op == CompareOp::GREATER_EQUAL ? _MM_CMPINT_NLT
+                                                                       : _MM_CMPINT_NLE;
+            const __m512i x = _mm512_loadu_si512(data + i);
+            mask = _mm512_cmp_epi32_mask(x, _mm512_set1_epi32(threshold), PREDICATE);
+            _mm512_mask_compressstoreu_epi32(out + count, mask, x);
+        }
+        count += static_cast<size_t>(__builtin_popcount(mask));
+    }
+    return count + FilterScalar<Op>(data + i, size - i, threshold, out + count);
+}
+
+#endif  // VECTOR_SIMD_X86
+
+// Лучший уровень, который поддерживает процессор
+inline SimdLevel DetectSimdLevel() noexcept {
+#ifdef VECTOR_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+    return SimdLevel::SSE2;
+#else
+    return SimdLevel::SCALAR;
+#endif
+}
+
+inline std::atomic<SimdLevel>& ActiveSimdLevel() noexcept {
+    static std::atomic<SimdLevel> level = DetectSimdLevel();
+    return level;
+}
+
+}  // namespace detail::simd
+
+inline SimdLevel GetSimdLevel() noexcept {
+    return detail::simd::ActiveSimdLevel().load(std::memory_order_relaxed);
+}
+
+// Ограничивает используемый набор инструкций (для тестов и сравнения вариантов).
+// Уровень выше поддерживаемого процессором понижается до него. Возвращает установленный уровень
+inline SimdLevel SetSimdLevel(SimdLevel level) noexcept {
+    level = std::min(level, detail::simd::DetectSimdLevel());
+    detail::simd::ActiveSimdLevel().store(level, std::memory_order_relaxed);
+    return level;
+}
+
+// Выбор варианта один раз на вызов: Scalar, Sse2, Avx2 или Avx512 в зависимости от GetSimdLevel
+#ifdef VECTOR_SIMD_X86
+#define VECTOR_SIMD_DISPATCH(T, NAME, ...)                                \
+    if constexpr (detail::simd::IS_VECTORIZED<T>) {                       \
+        switch (GetSimdLevel()) {                                         \
+            case SimdLevel::AVX512:                                       \
+                return detail::simd::NAME##Avx512(__VA_ARGS__);           \
+            case SimdLevel::AVX2:                                         \
+                return detail::simd::NAME##Avx2(__VA_ARGS__);             \
+            case SimdLevel::SSE2:                                         \
+                return detail::simd::NAME##Sse2(__VA_ARGS__);             \
+            case SimdLevel::SCALAR:                                       \
+                break;                                                    \
+        }                                                                 \
+    }                                                                     \
+    return detail::simd::NAME##Scalar(__VA_ARGS__)
+#else
+#define VECTOR_SIMD_DISPATCH(T, NAME, ...) return detail::simd::NAME##Scalar(__VA_ARGS__)
+#endif
+
+// Каждая функция принимает Vector или Span, например колонку SoAVector
+
+// Первый элемент, равный value, или end()
+template <typename T>
+T* Find(Span<T> s, std::remove_const_t<T> value) noexcept {
+    using Value = std::remove_const_t<T>;
+    static_assert(std::is_arithmetic_v<Value>, "Find requires an arithmetic element type");
+    auto find = [&]() -> size_t {
+        VECTOR_SIMD_DISPATCH(Value, Find, s.Data(), s.Size(), value);
+    };
+    return s.Data() + find();
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename Vector<T, Allocator, GrowthPolicy>::const_iterator Find(const Vector<T, Allocator, GrowthPolicy>& v,
+                                                                 T value) noexcept {
+    return Find(Span<const T>(v), value);
+}
+
+template <typename T>
+size_t Count(Span<T> s, std::remove_const_t<T> value) noexcept {
+    using Value = std::remove_const_t<T>;
+    static_assert(std::is_arithmetic_v<Value>, "Count requires an arithmetic element type");
+    VECTOR_SIMD_DISPATCH(Value, Count, s.Data(), s.Size(), value);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+size_t Count(const Vector<T, Allocator, GrowthPolicy>& v, T value) noexcept {
+    return Count(Span<const T>(v), value);
+}
+
+template <typename T>
+bool Contains(Span<T> s, std::remove_const_t<T> value) noexcept {
+    return Find(s, value) != s.end();
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+bool Contains(const Vector<T, Allocator, GrowthPolicy>& v, T value) noexcept {
+    return Contains(Span<const T>(v), value);
+}
+
+// Сумма элементов: целые суммируются в 64 битах, вещественные — в T.
+// Векторный вариант складывает вещественные в другом порядке, чем последовательный цикл,
+// так что результат может отличаться в последних разрядах
+template <typename T>
+detail::simd::SumType<std::remove_const_t<T>> Sum(Span<T> s) noexcept {
+    using Value = std::remove_const_t<T>;
+    static_assert(std::is_arithmetic_v<Value>, "Sum requires an arithmetic element type");
+    VECTOR_SIMD_DISPATCH(Value, Sum, s.Data(), s.Size());
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+detail::simd::SumType<T> Sum(const Vector<T, Allocator, GrowthPolicy>& v) noexcept {
+    return Sum(Span<const T>(v));
+}
+
+// Наименьший и наибольший элементы непустого диапазона. С NaN результат не определён
+template <typename T>
+std::pair<std::remove_const_t<T>, std::remove_const_t<T>> MinMax(Span<T> s) noexcept {
+    using Value = std::remove_const_t<T>;
+    static_assert(std::is_arithmetic_v<Value>, "MinMax requires an arithmetic element type");
+    assert(s.Size() > 0);
+    VECTOR_SIMD_DISPATCH(Value, MinMax, s.Data(), s.Size());
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+std::pair<T, T> MinMax(const Vector<T, Allocator, GrowthPolicy>& v) noexcept {
+    return MinMax(Span<const T>(v));
+}
+
+// Дописывает в out элементы s, для которых «элемент op threshold» истинно, сохраняя порядок.
+// Возвращает их количество. Под результат сразу резервируется место на все элементы s,
+// лишнее отрезается в конце, поэтому s не может указывать в out
+template <typename T, typename OutAllocator, typename OutGrowthPolicy>
+size_t Filter(Span<T> s, CompareOp op, std::remove_const_t<T> threshold,
+              Vector<std::remove_const_t<T>, OutAllocator, OutGrowthPolicy>& out) {
+    using Value = std::remove_const_t<T>;
+    static_assert(std::is_arithmetic_v<Value>, "Filter requires an arithmetic element type");
+    const size_t old_size = out.Size();
+    if (s.Size() == 0) {
+        return 0;
+    }
+    out.ResizeUninitialized(old_size + s.Size());
+    Value* dest = out.begin() + old_size;
+    const Value* data = s.Data();
+    const size_t count = detail::simd::WithCompareOp(op, [&](auto op_constant) -> size_t {
+        constexpr CompareOp OP = decltype(op_constant)::value;
+#ifdef VECTOR_SIMD_X86
+        if constexpr (detail::simd::IS_VECTORIZED<Value>) {
+            switch (GetSimdLevel()) {
+                case SimdLevel::AVX512:
+                    return detail::simd::FilterAvx512<OP>(data, s.Size(), threshold, dest);
+                case SimdLevel::AVX2:
+                    return detail::simd::FilterAvx2<OP>(data, s.Size(), threshold, dest);
+                case SimdLevel::SSE2:
+                    return detail::simd::FilterSse2<OP>(data, s.Size(), threshold, dest);
+                case SimdLevel::SCALAR:
+                    break;
+            }
+        }
+#endif
+        return detail::simd::FilterScalar<OP>(data, s.Size(), threshold, dest);
+    });
+    out.Resize(old_size + count);
+    return count;
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename OutAllocator, typename OutGrowthPolicy>
+size_t Filter(const Vector<T, Allocator, GrowthPolicy>& v, CompareOp op, T threshold,
+              Vector<T, OutAllocator, OutGrowthPolicy>& out) {
+    assert(static_cast<const void*>(&v) != static_cast<const void*>(&out));
+    return Filter(Span<const T>(v), op, threshold, out);
+}
+
+#undef VECTOR_SIMD_DISPATCH
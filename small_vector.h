@@ -0,0 +1,286 @@
+#pragma once
+#include "vector.h"
+
+// Вектор со встроенным буфером на N элементов.
+// Пока элементов не больше N, куча не трогается вовсе. При переполнении элементы переезжают
+// в RawMemory, выделенную Allocator'ом, и дальше растут по GrowthPolicy, как в Vector
+template <typename T, size_t N, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth>
+class SmallVector {
+    static_assert(N > 0, "SmallVector needs at least one inline element");
+    static_assert(!detail::REQUIRES_MALLOC_ALLOCATOR<GrowthPolicy> || IsMallocBacked<Allocator>::value,
+                  "MallocSizeClassGrowth models glibc malloc blocks and needs a malloc-backed allocator");
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    iterator begin() noexcept {
+        return Data();
+    }
+    iterator end() noexcept {
+        return Data() + size_;
+    }
+    const_iterator begin() const noexcept {
+        return Data();
+    }
+    const_iterator end() const noexcept {
+        return Data() + size_;
+    }
+    const_iterator cbegin() const noexcept {
+        return Data();
+    }
+    const_iterator cend() const noexcept {
+        return Data() + size_;
+    }
+
+    SmallVector() = default;
+
+    explicit SmallVector(const Allocator& alloc) noexcept
+        : heap_(alloc) {}
+
+    explicit SmallVector(size_t size, const Allocator& alloc = Allocator())
+        : heap_(alloc)
+    {
+        Reserve(size);
+        std::uninitialized_value_construct_n(Data(), size);
+        size_ = size;
+    }
+
+    SmallVector(const SmallVector& other)
+        : heap_(AllocTraits::select_on_container_copy_construction(other.heap_.GetAllocator()))
+    {
+        Reserve(other.size_);
+        detail::UninitializedCopyN(other.Data(), other.size_, Data());
+        size_ = other.size_;
+    }
+
+    // Аллокатор при присваивании не распространяется: память под элементы выделяет свой
+    SmallVector& operator=(const SmallVector& rhs) {
+        if (this != &rhs) {
+            if (size_ >= rhs.size_) {
+                std::copy(rhs.begin(), rhs.end(), begin());
+                detail::DestroyN(Data() + rhs.size_, size_ - rhs.size_);
+            } else if (Capacity() >= rhs.size_) {
+                std::copy(rhs.begin(), rhs.begin() + size_, begin());
+                detail::UninitializedCopyN(rhs.Data() + size_, rhs.size_ - size_, Data() + size_);
+            } else {
+                RawMemory<T, Allocator> new_data(rhs.size_, heap_.GetAllocator());
+                detail::UninitializedCopyN(rhs.Data(), rhs.size_, new_data.GetAddress());
+                detail::DestroyN(Data(), size_);
+                heap_.Swap(new_data);
+            }
+            size_ = rhs.size_;
+        }
+        return *this;
+    }
+
+    // Буфер в куче забирается целиком, элементы из встроенного буфера приходится переносить
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : heap_(other.heap_.GetAllocator())
+    {
+        if (other.IsInline()) {
+            detail::UninitializedRelocateN(other.Data(), other.size_, Data());
+            detail::DestroyRelocatedN(other.Data(), other.size_);
+        } else {
+            heap_.Swap(other.heap_);
+        }
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    SmallVector& operator=(SmallVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &rhs) {
+            detail::DestroyN(Data(), size_);
+            size_ = 0;
+            if (rhs.IsInline()) {
+                // rhs.size_ <= N, своя вместимость всегда не меньше N
+                detail::UninitializedRelocateN(rhs.Data(), rhs.size_, Data());
+                detail::DestroyRelocatedN(rhs.Data(), rhs.size_);
+            } else {
+                heap_.StealBuffer(rhs.heap_);
+            }
+            size_ = std::exchange(rhs.size_, 0);
+        }
+        return *this;
+    }
+
+    void Swap(SmallVector& other) {
+        SmallVector temp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+
+    ~SmallVector() {
+        detail::DestroyN(Data(), size_);
+    }
+
+    Allocator GetAllocator() const noexcept {
+        return heap_.GetAllocator();
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        RawMemory<T, Allocator> new_data(new_capacity, heap_.GetAllocator());
+        detail::UninitializedRelocateN(Data(), size_, new_data.GetAddress());
+        detail::DestroyRelocatedN(Data(), size_);
+        heap_.Swap(new_data);
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            detail::DestroyN(Data() + new_size, size_ - new_size);
+        } else if (new_size > size_) {
+            Reserve(new_size);
+            std::uninitialized_value_construct_n(Data() + size_, new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            RawMemory<T, Allocator> new_data(GrowthCapacity(size_ + 1), heap_.GetAllocator());
+            T* new_elem = new (new_data.GetAddress() + size_) T(std::forward<Args>(args)...);
+            try {
+                detail::UninitializedRelocateN(Data(), size_, new_data.GetAddress());
+            } catch (...) {
+                detail::DestroyN(new_elem, 1);
+                throw;
+            }
+            detail::DestroyRelocatedN(Data(), size_);
+            heap_.Swap(new_data);
+        } else {
+            new (Data() + size_) T(std::forward<Args>(args)...);
+        }
+        ++size_;
+        return Data()[size_ - 1];
+    }
+
+    template <typename S>
+    void PushBack(S&& value) {
+        EmplaceBack(std::forward<S>(value));
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        assert(cbegin() <= pos && pos <= cend());
+        const size_t index = pos - cbegin();
+        if (index > size_ || size_ > PTRDIFF_MAX / sizeof(T)) {
+            // Ни индекс, ни размер компилятору не ограничены: без подсказки GCC находит путь с хвостом
+            // почти в SIZE_MAX элементов и ругается на memcpy в побайтном переносе
+            detail::Unreachable();
+        }
+        const size_t tail = size_ - index;
+
+        if (tail == 0) {
+            EmplaceBack(std::forward<Args>(args)...);
+            return end() - 1;
+        }
+
+        if (size_ < Capacity()) {
+            T* it_pos = begin() + index;
+            if constexpr (IsTriviallyRelocatable<T>::value) {
+                detail::EmplaceIntoGap(it_pos, tail, std::forward<Args>(args)...);
+                ++size_;
+            } else {
+                T temp(std::forward<Args>(args)...);
+                new (end()) T(std::move(*(end() - 1)));
+                ++size_;
+                std::move_backward(it_pos, end() - 2, end() - 1);
+                *it_pos = std::move(temp);
+            }
+            return it_pos;
+        }
+
+        RawMemory<T, Allocator> new_data(GrowthCapacity(size_ + 1), heap_.GetAllocator());
+        T* new_elem = new (new_data.GetAddress() + index) T(std::forward<Args>(args)...);
+        try {
+            detail::UninitializedRelocateN(Data(), index, new_data.GetAddress());
+        } catch (...) {
+            detail::DestroyN(new_elem, 1);
+            throw;
+        }
+        try {
+            detail::UninitializedRelocateN(Data() + index, tail, new_elem + 1);
+        } catch (...) {
+            detail::DestroyN(new_data.GetAddress(), index + 1);
+            throw;
+        }
+        detail::DestroyRelocatedN(Data(), size_);
+        heap_.Swap(new_data);
+        ++size_;
+        return begin() + index;
+    }
+
+    // Побайтно перемещаемые T не переприсваиваются: удалённый разрушается, хвост сдвигается memmove
+    iterator Erase(const_iterator pos) {
+        assert(cbegin() <= pos && pos < cend());
+        iterator it_pos = begin() + (pos - cbegin());
+        if constexpr (IsTriviallyRelocatable<T>::value) {
+            detail::DestroyN(it_pos, 1);
+            detail::CloseGap(it_pos, static_cast<size_t>(end() - it_pos - 1), 1);
+        } else {
+            std::move(it_pos + 1, end(), it_pos);
+            detail::DestroyN(end() - 1, 1);
+        }
+        --size_;
+        return it_pos;
+    }
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        detail::DestroyN(end() - 1, 1);
+        --size_;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return IsInline() ? N : heap_.Capacity();
+    }
+
+    // Элементы лежат во встроенном буфере, а не в куче
+    bool IsInline() const noexcept {
+        return heap_.GetAddress() == nullptr;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SmallVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+private:
+    T* Data() noexcept {
+        return IsInline() ? reinterpret_cast<T*>(inline_) : heap_.GetAddress();
+    }
+
+    const T* Data() const noexcept {
+        return const_cast<SmallVector&>(*this).Data();
+    }
+
+    size_t GrowthCapacity(size_t required) const noexcept {
+        return GrowthPolicy::NextCapacity(Capacity(), required, sizeof(T));
+    }
+
+    alignas(T) unsigned char inline_[N * sizeof(T)];
+    RawMemory<T, Allocator> heap_;
+    size_t size_ = 0;
+};
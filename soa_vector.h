@@ -0,0 +1,426 @@
+#pragma once
+#include "vector.h"
+
+#include <tuple>
+
+// Структура массивов: SoAVector<int64_t, float, int32_t> хранит те же строки, что Vector<Row>
+// с полями этих типов, но каждое поле лежит в своей колонке RawMemory. Проход по одному полю
+// читает только его колонку, а не строки целиком, и её можно отдать векторным алгоритмам как Span.
+// Строка по индексу — кортеж ссылок на её поля, копия строки — std::tuple<Fields...>.
+// Колонки растут вместе по DoublingGrowth. Если поле не построилось в одной колонке,
+// остальные откатываются, так что гарантии исключений те же, что у Vector
+template <typename... Fields>
+class SoAVector {
+    static_assert(sizeof...(Fields) > 0, "SoAVector needs at least one field");
+
+    using Columns = std::tuple<RawMemory<Fields>...>;
+
+    static constexpr size_t NUM_COLUMNS = sizeof...(Fields);
+    static constexpr size_t ROW_BYTES = (sizeof(Fields) + ...);
+
+    // Строка — прокси, а не ссылка на объект, поэтому итератор формально только input:
+    // std::sort и прочие алгоритмы, меняющие элементы местами, с ним не работают
+    template <bool IsConst>
+    class Iterator {
+        using Owner = std::conditional_t<IsConst, const SoAVector, SoAVector>;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::tuple<Fields...>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::conditional_t<IsConst, std::tuple<const Fields&...>, std::tuple<Fields&...>>;
+
+        Iterator() = default;
+
+        Iterator(Owner* owner, size_t index) noexcept
+            : owner_(owner)
+            , index_(index) {}
+
+        // iterator -> const_iterator
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        Iterator(const Iterator<OtherConst>& other) noexcept
+            : owner_(other.owner_)
+            , index_(other.index_) {}
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+
+        size_t Index() const noexcept {
+            return index_;
+        }
+
+        Iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+        Iterator operator++(int) noexcept {
+            Iterator old = *this;
+            ++index_;
+            return old;
+        }
+        Iterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+        friend Iterator operator+(Iterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+        // Расстояние определено только для итераторов одного вектора
+        friend difference_type operator-(const Iterator& lhs, const Iterator& rhs) noexcept {
+            assert(lhs.owner_ == rhs.owner_);
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.owner_ == rhs.owner_ && lhs.index_ == rhs.index_;
+        }
+        friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+    private:
+        friend class Iterator<!IsConst>;
+
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+    using value_type = std::tuple<Fields...>;
+    using reference = std::tuple<Fields&...>;
+    using const_reference = std::tuple<const Fields&...>;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    template <size_t I>
+    using FieldType = std::tuple_element_t<I, value_type>;
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+    iterator end() noexcept {
+        return {this, size_};
+    }
+    const_iterator begin() const noexcept {
+        return {this, 0};
+    }
+    const_iterator end() const noexcept {
+        return {this, size_};
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    SoAVector() = default;
+
+    explicit SoAVector(size_t size) {
+        Resize(size);
+    }
+
+    SoAVector(const SoAVector& other)
+        : columns_(AllocateColumns(other.size_))
+    {
+        auto copy = [&](auto& column, auto i) {
+            detail::UninitializedCopyN(std::get<decltype(i)::value>(other.columns_).GetAddress(), other.size_,
+                                       column.GetAddress());
+        };
+        auto rollback = [&](auto& column, auto /*i*/) {
+            detail::DestroyN(column.GetAddress(), other.size_);
+        };
+        ConstructColumns(columns_, copy, rollback);
+        size_ = other.size_;
+    }
+
+    // Колонки переходят к новому владельцу целиком, элементы не трогаются
+    SoAVector(SoAVector&& other) noexcept
+        : columns_(std::move(other.columns_))
+        , size_(std::exchange(other.size_, 0)) {}
+
+    SoAVector& operator=(const SoAVector& rhs) {
+        if (this != &rhs) {
+            SoAVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    SoAVector& operator=(SoAVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Clear();
+            columns_ = std::move(rhs.columns_);
+            size_ = std::exchange(rhs.size_, 0);
+        }
+        return *this;
+    }
+
+    void Swap(SoAVector& other) noexcept {
+        std::swap(columns_, other.columns_);
+        std::swap(size_, other.size_);
+    }
+
+    ~SoAVector() {
+        Clear();
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > Capacity()) {
+            Reallocate(new_capacity);
+        }
+    }
+
+    void ShrinkToFit() {
+        if (Capacity() > size_) {
+            Reallocate(size_);
+        }
+    }
+
+    // Новые строки инициализируются значением, как в Vector
+    void Resize(size_t new_size) {
+        if (new_size <= size_) {
+            DestroyRows(columns_, new_size, size_ - new_size);
+            size_ = new_size;
+            return;
+        }
+        Reserve(new_size);
+        auto construct = [&](auto& column, auto /*i*/) {
+            std::uninitialized_value_construct_n(column.GetAddress() + size_, new_size - size_);
+        };
+        auto rollback = [&](auto& column, auto /*i*/) {
+            detail::DestroyN(column.GetAddress() + size_, new_size - size_);
+        };
+        ConstructColumns(columns_, construct, rollback);
+        size_ = new_size;
+    }
+
+    void Clear() noexcept {
+        DestroyRows(columns_, 0, size_);
+        size_ = 0;
+    }
+
+    // По аргументу на поле: каждое поле строится из своего аргумента
+    template <typename... Args>
+    reference EmplaceBack(Args&&... args) {
+        static_assert(sizeof...(Args) == NUM_COLUMNS, "EmplaceBack takes one argument per field");
+        auto values = std::forward_as_tuple(std::forward<Args>(args)...);
+        if (size_ == Capacity()) {
+            // Строка строится в новых колонках до переноса: аргументы могут ссылаться на строки вектора
+            Columns new_columns = AllocateColumns(DoublingGrowth::NextCapacity(Capacity(), size_ + 1, ROW_BYTES));
+            ConstructRow(new_columns, size_, values);
+            try {
+                RelocateTo(new_columns);
+            } catch (...) {
+                DestroyRows(new_columns, size_, 1);
+                throw;
+            }
+            DestroyRelocatedRows();
+            columns_ = std::move(new_columns);
+        } else {
+            ConstructRow(columns_, size_, values);
+        }
+        ++size_;
+        return (*this)[size_ - 1];
+    }
+
+    void PushBack(const value_type& row) {
+        std::apply([this](const Fields&... fields) {
+            EmplaceBack(fields...);
+        }, row);
+    }
+
+    void PushBack(value_type&& row) {
+        std::apply([this](Fields&... fields) {
+            EmplaceBack(std::move(fields)...);
+        }, row);
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        DestroyRows(columns_, size_, 1);
+    }
+
+    iterator Erase(const_iterator pos) {
+        assert(pos.Index() < size_);
+        return Erase(pos, pos + 1);
+    }
+
+    // Каждая колонка сдвигается своим проходом (для тривиально копируемых полей это memmove)
+    iterator Erase(const_iterator first, const_iterator last) {
+        const size_t begin = first.Index();
+        const size_t end = last.Index();
+        assert(begin <= end && end <= size_);
+        if (begin != end) {
+            ForEachColumn([&](auto& column) {
+                auto* data = column.GetAddress();
+                std::move(data + end, data + size_, data + begin);
+            });
+            DestroyRows(columns_, size_ - (end - begin), end - begin);
+            size_ -= end - begin;
+        }
+        return {this, begin};
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return std::get<0>(columns_).Capacity();
+    }
+
+    reference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return std::apply([index](auto&... column) {
+            return reference(column[index]...);
+        }, columns_);
+    }
+
+    const_reference operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return std::apply([index](const auto&... column) {
+            return const_reference(column[index]...);
+        }, columns_);
+    }
+
+    // Поле I строки index
+    template <size_t I>
+    FieldType<I>& Get(size_t index) noexcept {
+        assert(index < size_);
+        return std::get<I>(columns_)[index];
+    }
+
+    template <size_t I>
+    const FieldType<I>& Get(size_t index) const noexcept {
+        assert(index < size_);
+        return std::get<I>(columns_)[index];
+    }
+
+    // Колонка поля I целиком: непрерывный массив из Size() элементов.
+    // Как и указатели на элементы Vector, действительна до следующей реаллокации
+    template <size_t I>
+    Span<FieldType<I>> Column() noexcept {
+        return {std::get<I>(columns_).GetAddress(), size_};
+    }
+
+    template <size_t I>
+    Span<const FieldType<I>> Column() const noexcept {
+        return {std::get<I>(columns_).GetAddress(), size_};
+    }
+
+private:
+    // Тот же выбор, что в detail::UninitializedRelocateN: копирование бросает, но оставляет исходные целыми
+    template <typename Field>
+    static constexpr bool RELOCATES_BY_COPY = !IsTriviallyRelocatable<Field>::value
+        && !std::is_nothrow_move_constructible_v<Field> && std::is_copy_constructible_v<Field>;
+
+    static Columns AllocateColumns(size_t capacity) {
+        return Columns(RawMemory<Fields>(capacity)...);
+    }
+
+    template <typename Func>
+    void ForEachColumn(Func&& func) {
+        std::apply([&](auto&... column) {
+            (func(column), ...);
+        }, columns_);
+    }
+
+    // Вызывает construct(column, i) для колонок, начиная с I. Если колонка бросила исключение,
+    // для уже построенных вызывается rollback(column, i), и исключение летит дальше
+    template <size_t I = 0, typename Construct, typename Rollback>
+    static void ConstructColumns(Columns& columns, Construct& construct, Rollback& rollback) {
+        if constexpr (I < NUM_COLUMNS) {
+            auto& column = std::get<I>(columns);
+            construct(column, std::integral_constant<size_t, I>{});
+            try {
+                ConstructColumns<I + 1>(columns, construct, rollback);
+            } catch (...) {
+                rollback(column, std::integral_constant<size_t, I>{});
+                throw;
+            }
+        }
+    }
+
+    // Строит строку index из кортежа аргументов, по одному на поле
+    template <typename ArgsTuple>
+    static void ConstructRow(Columns& columns, size_t index, ArgsTuple& args) {
+        auto construct = [&](auto& column, auto i) {
+            using Field = FieldType<decltype(i)::value>;
+            new (column.GetAddress() + index) Field(std::get<decltype(i)::value>(std::move(args)));
+        };
+        auto rollback = [&](auto& column, auto /*i*/) {
+            detail::DestroyN(column.GetAddress() + index, 1);
+        };
+        ConstructColumns(columns, construct, rollback);
+    }
+
+    static void DestroyRows(Columns& columns, size_t index, size_t count) noexcept {
+        std::apply([&](auto&... column) {
+            (detail::DestroyN(column.GetAddress() + index, count), ...);
+        }, columns);
+    }
+
+    // Разрушает свои строки после RelocateTo
+    void DestroyRelocatedRows() noexcept {
+        ForEachColumn([&](auto& column) {
+            detail::DestroyRelocatedN(column.GetAddress(), size_);
+        });
+    }
+
+    // Переносит все строки в new_columns, исходные не разрушает (см. DestroyRelocatedRows).
+    // Сначала колонки, которые приходится копировать: при исключении их исходные целы, и достаточно
+    // разрушить копии. Перемещение начинается, только когда бросать больше нечему
+    void RelocateTo(Columns& new_columns) {
+        auto relocate = [&](bool by_copy) {
+            auto construct = [&](auto& new_column, auto i) {
+                if (RELOCATES_BY_COPY<FieldType<decltype(i)::value>> == by_copy) {
+                    detail::UninitializedRelocateN(std::get<decltype(i)::value>(columns_).GetAddress(), size_,
+                                                   new_column.GetAddress());
+                }
+            };
+            // Побайтные копии не разрушаются: владельцами остаются исходные элементы
+            auto rollback = [&](auto& new_column, auto i) {
+                using Field = FieldType<decltype(i)::value>;
+                if (RELOCATES_BY_COPY<Field> == by_copy && !IsTriviallyRelocatable<Field>::value) {
+                    detail::DestroyN(new_column.GetAddress(), size_);
+                }
+            };
+            ConstructColumns(new_columns, construct, rollback);
+        };
+        relocate(true);
+        try {
+            relocate(false);
+        } catch (...) {
+            // Перемещение бросает, только если у поля нет копирования: исходные элементы уже испорчены,
+            // как и в Vector в этом случае, но копии остальных колонок освобождаем
+            auto destroy_copies = [&](auto& new_column, auto i) {
+                if (RELOCATES_BY_COPY<FieldType<decltype(i)::value>>) {
+                    detail::DestroyN(new_column.GetAddress(), size_);
+                }
+            };
+            auto nothing = [](auto& /*new_column*/, auto /*i*/) {};
+            ConstructColumns(new_columns, destroy_copies, nothing);
+            throw;
+        }
+    }
+
+    // Переносит строки в колонки ровно на new_capacity (>= size_) элементов
+    void Reallocate(size_t new_capacity) {
+        assert(new_capacity >= size_);
+        Columns new_columns = AllocateColumns(new_capacity);
+        RelocateTo(new_columns);
+        DestroyRelocatedRows();
+        columns_ = std::move(new_columns);
+    }
+
+    Columns columns_;
+    size_t size_ = 0;
+};
+
+// Колонки — указатели на буферы и размер
+template <typename... Fields>
+struct IsTriviallyRelocatable<SoAVector<Fields...>> : std::true_type {};
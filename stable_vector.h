@@ -0,0 +1,309 @@
+#pragma once
+#include "vector.h"
+
+namespace detail {
+
+// Сколько элементов помещается в блок около 4 КиБ (степень двойки, чтобы индекс делился сдвигом)
+template <typename T>
+constexpr size_t DefaultChunkSize() noexcept {
+    size_t chunk = 1;
+    while (chunk * 2 * sizeof(T) <= 4096) {
+        chunk *= 2;
+    }
+    return chunk;
+}
+
+}  // namespace detail
+
+// Вектор, элементы которого никогда не переезжают.
+// Они лежат в блоках RawMemory по ChunkSize элементов, таблица блоков — обычный Vector.
+// Рост только добавляет блок (переезжают лишь дескрипторы блоков в таблице), поэтому указатели
+// и ссылки на элементы остаются действительными до удаления самих элементов.
+// Доступ по индексу — O(1): номер блока и смещение в нём получаются сдвигом и маской.
+// Итераторы хранят адрес вектора и индекс, так что переживают и рост тоже. Но они привязаны к самому
+// объекту StableVector: перемещение, перемещающее присваивание и Swap уносят элементы в другой объект,
+// и итераторы обоих векторов инвалидируются, хотя указатели и ссылки на элементы остаются действительными
+template <typename T, size_t ChunkSize = detail::DefaultChunkSize<T>(), typename Allocator = std::allocator<T>>
+class StableVector {
+    static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using Chunk = RawMemory<T, Allocator>;
+    using ChunkTable = Vector<Chunk, typename AllocTraits::template rebind_alloc<Chunk>>;
+
+    template <bool IsConst>
+    class Iterator {
+        using Owner = std::conditional_t<IsConst, const StableVector, StableVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+
+        Iterator() = default;
+
+        Iterator(Owner* owner, size_t index) noexcept
+            : owner_(owner)
+            , index_(index) {}
+
+        // iterator -> const_iterator
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        Iterator(const Iterator<OtherConst>& other) noexcept
+            : owner_(other.owner_)
+            , index_(other.index_) {}
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+        pointer operator->() const noexcept {
+            return &(*owner_)[index_];
+        }
+        reference operator[](difference_type offset) const noexcept {
+            return (*owner_)[index_ + offset];
+        }
+
+        Iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+        Iterator operator++(int) noexcept {
+            Iterator old = *this;
+            ++index_;
+            return old;
+        }
+        Iterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+        Iterator operator--(int) noexcept {
+            Iterator old = *this;
+            --index_;
+            return old;
+        }
+        Iterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+        Iterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+        friend Iterator operator+(Iterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+        friend Iterator operator+(difference_type offset, Iterator it) noexcept {
+            return it += offset;
+        }
+        friend Iterator operator-(Iterator it, difference_type offset) noexcept {
+            return it -= offset;
+        }
+        // Расстояние и порядок определены только для итераторов одного вектора
+        friend difference_type operator-(const Iterator& lhs, const Iterator& rhs) noexcept {
+            assert(lhs.owner_ == rhs.owner_);
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.owner_ == rhs.owner_ && lhs.index_ == rhs.index_;
+        }
+        friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+        friend bool operator<(const Iterator& lhs, const Iterator& rhs) noexcept {
+            assert(lhs.owner_ == rhs.owner_);
+            return lhs.index_ < rhs.index_;
+        }
+        friend bool operator>(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return rhs < lhs;
+        }
+        friend bool operator<=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return !(rhs < lhs);
+        }
+        friend bool operator>=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return !(lhs < rhs);
+        }
+
+    private:
+        friend class Iterator<!IsConst>;
+
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    static constexpr size_t CHUNK_SIZE = ChunkSize;
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+    iterator end() noexcept {
+        return {this, size_};
+    }
+    const_iterator begin() const noexcept {
+        return {this, 0};
+    }
+    const_iterator end() const noexcept {
+        return {this, size_};
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    StableVector() = default;
+
+    explicit StableVector(const Allocator& alloc)
+        : alloc_(alloc)
+        , chunks_(typename AllocTraits::template rebind_alloc<Chunk>(alloc)) {}
+
+    explicit StableVector(size_t size, const Allocator& alloc = Allocator())
+        : StableVector(alloc)
+    {
+        Resize(size);
+    }
+
+    StableVector(const StableVector& other)
+        : StableVector(AllocTraits::select_on_container_copy_construction(other.alloc_))
+    {
+        Reserve(other.size_);
+        for (const T& value : other) {
+            EmplaceBack(value);
+        }
+    }
+
+    // Перемещение забирает таблицу блоков целиком, элементы остаются на своих местах.
+    // Итераторы other при этом инвалидируются: они указывают на other, а не на элементы
+    StableVector(StableVector&& other) noexcept
+        : alloc_(other.alloc_)
+        , chunks_(std::move(other.chunks_))
+        , size_(std::exchange(other.size_, 0)) {}
+
+    StableVector& operator=(const StableVector& rhs) {
+        if (this != &rhs) {
+            StableVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    StableVector& operator=(StableVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Clear();
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                alloc_ = rhs.alloc_;
+            }
+            chunks_ = std::move(rhs.chunks_);
+            size_ = std::exchange(rhs.size_, 0);
+        }
+        return *this;
+    }
+
+    // Ссылки на элементы переходят вместе с ними, итераторы обоих векторов инвалидируются
+    void Swap(StableVector& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        }
+        chunks_.Swap(other.chunks_);
+        std::swap(size_, other.size_);
+    }
+
+    ~StableVector() {
+        Clear();
+    }
+
+    Allocator GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Выделяет блоки, чтобы вместить capacity элементов. Существующие элементы не трогаются
+    void Reserve(size_t capacity) {
+        const size_t num_chunks = (capacity + ChunkSize - 1) / ChunkSize;
+        chunks_.Reserve(num_chunks);
+        while (chunks_.Size() < num_chunks) {
+            chunks_.EmplaceBack(ChunkSize, alloc_);
+        }
+    }
+
+    void Resize(size_t new_size) {
+        while (size_ > new_size) {
+            PopBack();
+        }
+        Reserve(new_size);
+        while (size_ < new_size) {
+            EmplaceBack();
+        }
+    }
+
+    // Освобождает блоки, в которых не осталось элементов
+    void ShrinkToFit() {
+        const size_t used_chunks = (size_ + ChunkSize - 1) / ChunkSize;
+        chunks_.Erase(chunks_.begin() + used_chunks, chunks_.end());
+        chunks_.ShrinkToFit();
+    }
+
+    // Разрушает все элементы, блоки остаются для повторного заполнения
+    void Clear() noexcept {
+        for (size_t i = 0; i * ChunkSize < size_; ++i) {
+            detail::DestroyN(chunks_[i].GetAddress(), std::min(ChunkSize, size_ - i * ChunkSize));
+        }
+        size_ = 0;
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            chunks_.EmplaceBack(ChunkSize, alloc_);
+        }
+        T* slot = chunks_[size_ / ChunkSize].GetAddress() + size_ % ChunkSize;
+        new (slot) T(std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    template <typename S>
+    void PushBack(S&& value) {
+        EmplaceBack(std::forward<S>(value));
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        detail::DestroyN(chunks_[size_ / ChunkSize].GetAddress() + size_ % ChunkSize, 1);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return chunks_.Size() * ChunkSize;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<StableVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return chunks_[index / ChunkSize][index % ChunkSize];
+    }
+
+private:
+    Allocator alloc_ = Allocator();
+    ChunkTable chunks_;
+    size_t size_ = 0;
+};
+
+// Таблица блоков — Vector, сами элементы при переносе StableVector не двигаются
+template <typename T, size_t ChunkSize, typename Allocator>
+struct IsTriviallyRelocatable<StableVector<T, ChunkSize, Allocator>> : IsTriviallyRelocatable<Allocator> {};
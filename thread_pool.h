@@ -0,0 +1,301 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+class ThreadPool;
+
+namespace detail {
+
+// Пул и номер рабочего, который исполняется в этом потоке (у внешних потоков пула нет)
+struct CurrentWorker {
+    const ThreadPool* pool = nullptr;
+    size_t index = 0;
+};
+
+inline thread_local CurrentWorker current_worker;
+
+}  // namespace detail
+
+// Пул потоков с кражей работы.
+// У каждого рабочего своя очередь: свои задачи он берёт с конца (последние поставленные ещё в кэше),
+// а опустев, крадёт с начала чужих очередей самые старые, обычно самые крупные. Задачи из внешних
+// потоков попадают в общую очередь, которую рабочие проверяют после своей.
+// Поток, ждущий TaskGroup, сам выполняет задачи пула, поэтому пул из N - 1 рабочих вместе
+// с ждущим занимает N ядер, а вложенные группы не взаимоблокируются
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    // Все ядра, кроме одного: его займёт поток, ждущий результат
+    static size_t DefaultWorkers() noexcept {
+        const size_t cores = std::thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 0;
+    }
+
+    explicit ThreadPool(size_t num_workers = DefaultWorkers())
+        : num_workers_(num_workers)
+        , queues_(num_workers + 1)
+    {
+        threads_.Reserve(num_workers);
+        try {
+            for (size_t i = 0; i < num_workers; ++i) {
+                threads_.EmplaceBack([this, i] {
+                    WorkerLoop(i);
+                });
+            }
+        } catch (...) {
+            Stop();
+            throw;
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Дожидается задач, оставшихся в очередях
+    ~ThreadPool() {
+        Stop();
+        while (RunPendingTask()) {
+        }
+    }
+
+    // Число рабочих потоков
+    size_t Size() const noexcept {
+        return num_workers_;
+    }
+
+    // Сколько потоков выполняют задачи, пока вызывающий ждёт результата
+    size_t Concurrency() const noexcept {
+        return num_workers_ + 1;
+    }
+
+    // Исключение из задачи, поставленной напрямую, завершает программу, как и в std::thread.
+    // Чтобы получить его обратно, ставьте задачи через TaskGroup
+    void Submit(Task task) {
+        bool waiters_asleep = false;
+        {
+            // Счётчик растёт раньше, чем задача появится в очереди: проснувшийся рабочий
+            // в худшем случае лишний раз пройдёт по очередям, но не уснёт при непустой
+            std::lock_guard lock(sleep_mutex_);
+            ++queued_;
+            waiters_asleep = sleeping_waiters_ > 0;
+        }
+        try {
+            WorkQueue& queue = queues_[OwnQueue()];
+            std::lock_guard lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        } catch (...) {
+            std::lock_guard lock(sleep_mutex_);
+            --queued_;
+            throw;
+        }
+        wake_.notify_one();
+        // Ждущий группу тоже выполняет задачи, а без рабочих (или когда все они ждут вложенных групп)
+        // кроме него это сделать некому
+        if (waiters_asleep) {
+            waiters_wake_.notify_one();
+        }
+    }
+
+    // Берёт одну задачу (свою, из общей очереди или чужую) и выполняет её.
+    // Возвращает false, если задач не нашлось
+    bool RunPendingTask() {
+        Task task;
+        if (!TakeTask(task)) {
+            return false;
+        }
+        task();
+        return true;
+    }
+
+private:
+    friend class TaskGroup;
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // Своя очередь рабочего или общая (последняя) для внешних потоков
+    size_t OwnQueue() const noexcept {
+        return detail::current_worker.pool == this ? detail::current_worker.index : num_workers_;
+    }
+
+    // Сначала своя очередь, затем общая, затем чужие по кругу, начиная с соседней
+    bool TakeTask(Task& task) {
+        const size_t own = OwnQueue();
+        const bool is_worker = own != num_workers_;
+        if (TakeFrom(own, is_worker, task) || (is_worker && TakeFrom(num_workers_, false, task))) {
+            return true;
+        }
+        const size_t start = is_worker ? own + 1 : 0;
+        for (size_t k = 0; k < num_workers_; ++k) {
+            const size_t victim = (start + k) % num_workers_;
+            if (victim != own && TakeFrom(victim, false, task)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool TakeFrom(size_t index, bool from_back, Task& task) {
+        WorkQueue& queue = queues_[index];
+        std::lock_guard lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        if (from_back) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void WorkerLoop(size_t index) {
+        detail::current_worker = {this, index};
+        while (true) {
+            if (RunPendingTask()) {
+                continue;
+            }
+            std::unique_lock lock(sleep_mutex_);
+            wake_.wait(lock, [this] {
+                return stopped_ || queued_.load(std::memory_order_relaxed) > 0;
+            });
+            if (stopped_ && queued_.load(std::memory_order_relaxed) == 0) {
+                return;
+            }
+        }
+    }
+
+    // Засыпает, пока в очередях нет задач и done() ложно. Тот, кто делает done() истинным, зовёт WakeWaiters.
+    // Ждущие группы спят на своей переменной, чтобы завершение группы не будило простаивающих рабочих
+    template <typename Predicate>
+    void WaitForTaskOr(Predicate done) {
+        std::unique_lock lock(sleep_mutex_);
+        ++sleeping_waiters_;
+        waiters_wake_.wait(lock, [&] {
+            return done() || stopped_ || queued_.load(std::memory_order_relaxed) > 0;
+        });
+        --sleeping_waiters_;
+    }
+
+    // Будит ждущих групп, если кто-то из них спит. Условие ждущий проверяет под sleep_mutex_,
+    // так что он либо увидит done(), либо уже учтён в sleeping_waiters_
+    void WakeWaiters() noexcept {
+        bool waiters_asleep = false;
+        {
+            std::lock_guard lock(sleep_mutex_);
+            waiters_asleep = sleeping_waiters_ > 0;
+        }
+        if (waiters_asleep) {
+            waiters_wake_.notify_all();
+        }
+    }
+
+    void Stop() noexcept {
+        {
+            std::lock_guard lock(sleep_mutex_);
+            stopped_ = true;
+        }
+        wake_.notify_all();
+        waiters_wake_.notify_all();
+        for (std::thread& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    // Рабочие читают его, пока конструктор ещё заполняет threads_
+    const size_t num_workers_;
+    Vector<WorkQueue> queues_;
+    Vector<std::thread> threads_;
+    std::mutex sleep_mutex_;
+    // Простаивающие рабочие
+    std::condition_variable wake_;
+    // Потоки, ждущие TaskGroup, и сколько их спит (под sleep_mutex_)
+    std::condition_variable waiters_wake_;
+    size_t sleeping_waiters_ = 0;
+    std::atomic<size_t> queued_ = 0;
+    bool stopped_ = false;
+};
+
+// Группа задач, которых можно дождаться вместе.
+// Первое исключение, вылетевшее из задачи, пробрасывается из Wait, остальные задачи группы доработают
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) noexcept
+        : pool_(pool) {}
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // Задачи ссылаются на группу, так что она не может умереть раньше них
+    ~TaskGroup() {
+        WaitAll();
+    }
+
+    template <typename Func>
+    void Run(Func&& func) {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        try {
+            // Группу могут разрушить сразу после последнего fetch_sub, поэтому пул берётся не через this
+            pool_.Submit([this, &pool = pool_, func = std::forward<Func>(func)]() mutable {
+                try {
+                    func();
+                } catch (...) {
+                    std::lock_guard lock(error_mutex_);
+                    if (!error_) {
+                        error_ = std::current_exception();
+                    }
+                }
+                if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    pool.WakeWaiters();
+                }
+            });
+        } catch (...) {
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            throw;
+        }
+    }
+
+    void Wait() {
+        WaitAll();
+        if (error_) {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+    }
+
+private:
+    // Пока задачи группы не доделаны, помогает пулу: возможно, они стоят в очереди за другими
+    void WaitAll() noexcept {
+        while (pending_.load(std::memory_order_acquire) != 0) {
+            bool ran = false;
+            try {
+                ran = pool_.RunPendingTask();
+            } catch (...) {
+                // Задачи TaskGroup ловят свои исключения сами, сюда попадают только чужие задачи пула
+                std::terminate();
+            }
+            if (!ran) {
+                pool_.WaitForTaskOr([this] {
+                    return pending_.load(std::memory_order_acquire) == 0;
+                });
+            }
+        }
+    }
+
+    ThreadPool& pool_;
+    std::atomic<size_t> pending_ = 0;
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
@@ -1,46 +1,431 @@
 #pragma once
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <new>
 #include <utility>
 #include <memory>
+#include <memory_resource>
 #include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace detail {
+
+// operator new, который учитывает выравнивание сверх стандартного (alignas(32) и т.п.)
+inline void* AllocateAligned(size_t bytes, size_t alignment) {
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        return operator new(bytes, std::align_val_t{alignment});
+    }
+    return operator new(bytes);
+}
+
+inline void DeallocateAligned(void* buf, size_t bytes, size_t alignment) noexcept {
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        operator delete(buf, bytes, std::align_val_t{alignment});
+    } else {
+        operator delete(buf, bytes);
+    }
+}
+
+}  // namespace detail
+
+// Аллокатор, выравнивающий буфер на Alignment байт (но не меньше alignof(T)) даже для обычных T,
+// например чтобы векторизованный цикл по Vector<float> всегда начинался с границы кэш-линии
+template <typename T, size_t Alignment = 64>
+class AlignedAllocator {
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+
+public:
+    using value_type = T;
+
+    static constexpr size_t ALIGNMENT = std::max(Alignment, alignof(T));
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>& /*other*/) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > SIZE_MAX / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(operator new(n * sizeof(T), std::align_val_t{ALIGNMENT}));
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        operator delete(buf, n * sizeof(T), std::align_val_t{ALIGNMENT});
+    }
+
+    bool operator==(const AlignedAllocator& /*other*/) const noexcept {
+        return true;
+    }
+
+    bool operator!=(const AlignedAllocator& /*other*/) const noexcept {
+        return false;
+    }
+};
+
+// Аллокатор поверх malloc/realloc, блоки от MmapThreshold байт и больше берутся напрямую через mmap.
+// Помимо allocate/deallocate умеет reallocate: realloc для средних блоков и mremap для больших,
+// так что растущий буфер тривиально копируемых элементов не приходится копировать вручную
+template <typename T, size_t MmapThreshold = (size_t(32) << 20)>
+class ReallocAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "malloc does not guarantee such alignment");
+
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = ReallocAllocator<U, MmapThreshold>;
+    };
+
+    ReallocAllocator() noexcept = default;
+
+    template <typename U>
+    ReallocAllocator(const ReallocAllocator<U, MmapThreshold>& /*other*/) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        const size_t bytes = Bytes(n);
+        void* buf = IsMapped(bytes) ? Map(bytes) : std::malloc(bytes);
+        if (buf == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(buf);
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (IsMapped(bytes)) {
+            Unmap(buf, bytes);
+        } else {
+            std::free(buf);
+        }
+    }
+
+    // Меняет размер блока buf с old_n на new_n элементов, сохраняя первые min(old_n, new_n) побайтно.
+    // При исключении блок buf остаётся нетронутым
+    T* reallocate(T* buf, size_t old_n, size_t new_n) {
+        const size_t old_bytes = old_n * sizeof(T);
+        const size_t new_bytes = Bytes(new_n);
+        void* new_buf = nullptr;
+        if (!IsMapped(old_bytes) && !IsMapped(new_bytes)) {
+            new_buf = std::realloc(static_cast<void*>(buf), new_bytes);
+        } else if (IsMapped(old_bytes) && IsMapped(new_bytes)) {
+            new_buf = Remap(buf, old_bytes, new_bytes);
+        } else {
+            // Переход между кучей и mmap: без копирования не обойтись
+            new_buf = IsMapped(new_bytes) ? Map(new_bytes) : std::malloc(new_bytes);
+            if (new_buf != nullptr) {
+                std::memcpy(new_buf, buf, std::min(old_bytes, new_bytes));
+                deallocate(buf, old_n);
+            }
+        }
+        if (new_buf == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(new_buf);
+    }
+
+    bool operator==(const ReallocAllocator& /*other*/) const noexcept {
+        return true;
+    }
+
+    bool operator!=(const ReallocAllocator& /*other*/) const noexcept {
+        return false;
+    }
+
+private:
+    static size_t Bytes(size_t n) {
+        if (n > SIZE_MAX / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        return n * sizeof(T);
+    }
+
+#ifdef __linux__
+    static bool IsMapped(size_t bytes) noexcept {
+        return bytes >= MmapThreshold;
+    }
+
+    // Длина отображения округляется до страницы, поэтому её можно восстановить по числу элементов
+    static size_t PageAligned(size_t bytes) noexcept {
+        static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return (bytes + page_size - 1) / page_size * page_size;
+    }
+
+    static void* Map(size_t bytes) noexcept {
+        void* buf = mmap(nullptr, PageAligned(bytes), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return buf != MAP_FAILED ? buf : nullptr;
+    }
+
+    static void* Remap(void* buf, size_t old_bytes, size_t new_bytes) noexcept {
+        void* new_buf = mremap(buf, PageAligned(old_bytes), PageAligned(new_bytes), MREMAP_MAYMOVE);
+        return new_buf != MAP_FAILED ? new_buf : nullptr;
+    }
+
+    static void Unmap(void* buf, size_t bytes) noexcept {
+        munmap(buf, PageAligned(bytes));
+    }
+#else
+    // Без mremap все блоки живут в куче и растут через realloc
+    static bool IsMapped(size_t /*bytes*/) noexcept {
+        return false;
+    }
+
+    static void* Map(size_t /*bytes*/) noexcept {
+        return nullptr;
+    }
+
+    static void* Remap(void* /*buf*/, size_t /*old_bytes*/, size_t /*new_bytes*/) noexcept {
+        return nullptr;
+    }
+
+    static void Unmap(void* /*buf*/, size_t /*bytes*/) noexcept {
+    }
+#endif
+};
+
+// Настройки HugePageAllocator
+struct HugePageOptions {
+    // Блоки от threshold байт и больше отображаются через mmap и помечаются MADV_HUGEPAGE,
+    // меньшие берутся из обычной кучи
+    size_t threshold = size_t(2) << 20;
+    // Заранее отобразить все страницы блока, чтобы первое обращение не упиралось в page fault
+    bool prefault = false;
+    // Закрепить блок в памяти (mlock), чтобы его страницы не вытеснялись. Ошибка mlock
+    // (например, из-за RLIMIT_MEMLOCK) не фатальна: блок просто остаётся незакреплённым
+    bool lock = false;
+};
+
+// Аллокатор для больших таблиц: крупные блоки выравниваются на 2 МиБ и отдаются под
+// прозрачные huge pages, что сокращает промахи TLB при случайном доступе.
+// Настройки путешествуют вместе с контейнером при копировании, перемещении и обмене
+template <typename T>
+class HugePageAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    static constexpr size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+
+    HugePageAllocator() noexcept = default;
+
+    explicit HugePageAllocator(HugePageOptions options) noexcept
+        : options_(options) {}
+
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U>& other) noexcept
+        : options_(other.GetOptions()) {}
+
+    T* allocate(size_t n) {
+        if (n > (SIZE_MAX - 2 * HUGE_PAGE_SIZE) / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        const size_t bytes = n * sizeof(T);
+        if (!IsMapped(bytes)) {
+            return static_cast<T*>(detail::AllocateAligned(bytes, alignof(T)));
+        }
+        return static_cast<T*>(Map(bytes));
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (!IsMapped(bytes)) {
+            detail::DeallocateAligned(buf, bytes, alignof(T));
+            return;
+        }
+#ifdef __linux__
+        munmap(buf, MappedBytes(bytes));
+#endif
+    }
+
+    const HugePageOptions& GetOptions() const noexcept {
+        return options_;
+    }
+
+    // Блоки, выделенные одним аллокатором, может освободить другой с тем же порогом
+    bool operator==(const HugePageAllocator& other) const noexcept {
+        return options_.threshold == other.options_.threshold;
+    }
+
+    bool operator!=(const HugePageAllocator& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    bool IsMapped(size_t bytes) const noexcept {
+#ifdef __linux__
+        return bytes >= options_.threshold;
+#else
+        (void)bytes;
+        return false;
+#endif
+    }
+
+    static size_t MappedBytes(size_t bytes) noexcept {
+        return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+
+#ifdef __linux__
+    void* Map(size_t bytes) const {
+        const size_t mapped_bytes = MappedBytes(bytes);
+        // mmap выравнивает только на обычную страницу: берём с запасом и обрезаем края,
+        // чтобы ядро могло отдать блок целыми huge pages
+        const size_t reserved_bytes = mapped_bytes + HUGE_PAGE_SIZE;
+        void* reserved = mmap(nullptr, reserved_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (reserved == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        const uintptr_t reserved_begin = reinterpret_cast<uintptr_t>(reserved);
+        const uintptr_t begin = (reserved_begin + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        const size_t head = begin - reserved_begin;
+        if (head != 0) {
+            munmap(reserved, head);
+        }
+        munmap(reinterpret_cast<void*>(begin + mapped_bytes), reserved_bytes - head - mapped_bytes);
+
+        void* buf = reinterpret_cast<void*>(begin);
+        madvise(buf, mapped_bytes, MADV_HUGEPAGE);
+        if (options_.prefault) {
+            Prefault(buf, mapped_bytes);
+        }
+        if (options_.lock) {
+            mlock(buf, mapped_bytes);
+        }
+        return buf;
+    }
+
+    // MAP_POPULATE отработал бы до madvise и отобразил блок обычными страницами,
+    // поэтому страницы подкачиваются уже после MADV_HUGEPAGE
+    static void Prefault(void* buf, size_t bytes) noexcept {
+#ifdef MADV_POPULATE_WRITE
+        if (madvise(buf, bytes, MADV_POPULATE_WRITE) == 0) {
+            return;
+        }
+#endif
+        // Старые ядра: достаточно записать по байту в каждую страницу
+        static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        volatile unsigned char* bytes_ptr = static_cast<unsigned char*>(buf);
+        for (size_t offset = 0; offset < bytes; offset += page_size) {
+            bytes_ptr[offset] = 0;
+        }
+    }
+#else
+    void* Map(size_t /*bytes*/) const {
+        throw std::bad_alloc();
+    }
+#endif
+
+    HugePageOptions options_;
+};
+
+// Точка настройки в духе P1144: объект T можно перенести в другое место памяти побайтно (memcpy),
+// не вызывая перемещающий конструктор для нового и деструктор для старого. Годится для типов, которые
+// не хранят указателей на самих себя и не регистрируют свой адрес: дескрипторы, умные указатели,
+// большинство контейнеров. По умолчанию — только тривиально копируемые типы; свой тип объявляется так:
+//     template <> struct IsTriviallyRelocatable<MyHandle> : std::true_type {};
+// Контейнеры переносят такие T при реаллокации одним memcpy и удаляют из середины одним memmove
+template <typename T, typename = void>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+// Стандартные типы, перемещаемые побайтно в libstdc++. std::string сюда не входит: короткая строка
+// лежит внутри объекта, и его указатель на данные смотрит на самого себя. По той же причине
+// (сторожевой узел внутри объекта) не входят std::list, std::map и std::set
+// Аллокаторы без состояния или с указателем на ресурс: их копирующие конструкторы не тривиальны,
+// но побайтная копия ничем не хуже
+template <typename T>
+struct IsTriviallyRelocatable<std::allocator<T>> : std::true_type {};
+
+template <typename T>
+struct IsTriviallyRelocatable<std::pmr::polymorphic_allocator<T>> : std::true_type {};
+
+template <typename T, typename Deleter>
+struct IsTriviallyRelocatable<std::unique_ptr<T, Deleter>> : IsTriviallyRelocatable<Deleter> {};
+
+template <typename T>
+struct IsTriviallyRelocatable<std::shared_ptr<T>> : std::true_type {};
 
 template <typename T>
+struct IsTriviallyRelocatable<std::weak_ptr<T>> : std::true_type {};
+
+template <typename First, typename Second>
+struct IsTriviallyRelocatable<std::pair<First, Second>>
+    : std::conjunction<IsTriviallyRelocatable<First>, IsTriviallyRelocatable<Second>> {};
+
+// Определяет, умеет ли аллокатор менять размер блока на месте (метод reallocate)
+template <typename Allocator, typename = void>
+struct HasReallocate : std::false_type {};
+
+template <typename Allocator>
+struct HasReallocate<Allocator, std::void_t<decltype(std::declval<Allocator&>().reallocate(
+        std::declval<typename Allocator::value_type*>(), size_t{}, size_t{}))>> : std::true_type {};
+
+// Сырая память под capacity элементов типа T.
+// Выделение и освобождение идут через Allocator (любой, совместимый с std::allocator_traits).
+template <typename T, typename Allocator = std::allocator<T>>
 class RawMemory {
+    using AllocTraits = std::allocator_traits<Allocator>;
+    static_assert(std::is_same_v<typename AllocTraits::value_type, T>,
+                  "Allocator::value_type must be T");
+    static_assert(std::is_same_v<typename AllocTraits::pointer, T*>,
+                  "Fancy pointers are not supported");
+
 public:
+    using allocator_type = Allocator;
+
+    // Буфер можно растить без поэлементного переноса: элементы переносятся побайтно,
+    // а аллокатор умеет reallocate
+    static constexpr bool CAN_REALLOCATE = IsTriviallyRelocatable<T>::value && HasReallocate<Allocator>::value;
+
     RawMemory() = default;
 
-    explicit RawMemory(size_t capacity)
-        : buffer_(Allocate(capacity))
+    explicit RawMemory(const Allocator& alloc) noexcept
+        : alloc_(alloc) {}
+
+    explicit RawMemory(size_t capacity, const Allocator& alloc = Allocator())
+        : alloc_(alloc)
+        , buffer_(Allocate(capacity))
         , capacity_(capacity) {}
 
     RawMemory(const RawMemory&) = delete;
     RawMemory& operator=(const RawMemory& rhs) = delete;
 
+    // Буфер просто переходит к новому владельцу: ни выделений, ни копирования.
+    // Аллокатор копируется, у other остаётся рабочий аллокатор и пустой буфер
     RawMemory(RawMemory&& other) noexcept
-        : buffer_(Allocate(other.capacity_))
-        , capacity_(other.capacity_)
-    {
-        buffer_ = nullptr;
-        std::swap(buffer_, other.buffer_);
-    }
-//    RawMemory(RawMemory&& other) noexcept
-//        : buffer_(other.buffer_)
-//        , capacity_(other.capacity_)
-//    {
-//        other.buffer_ = nullptr;
-//        //std::swap(buffer_, other.buffer_);
-//    }
+        : alloc_(other.alloc_)
+        , buffer_(std::exchange(other.buffer_, nullptr))
+        , capacity_(std::exchange(other.capacity_, 0)) {}
 
     RawMemory& operator=(RawMemory&& rhs) noexcept {
-        RawMemory rhs_copy(std::move(rhs));
-        this->Swap(rhs_copy);
+        if (this != &rhs) {
+            StealBuffer(rhs);
+        }
         return *this;
     }
 
     ~RawMemory() {
-        Deallocate(buffer_);
+        Deallocate(buffer_, capacity_);
     }
 
     T* operator+(size_t offset) noexcept {
@@ -62,11 +447,58 @@ public:
         return buffer_[index];
     }
 
+    // Без propagate_on_container_swap обмен возможен только при равных аллокаторах
     void Swap(RawMemory& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        } else {
+            assert(alloc_ == other.alloc_);
+        }
         std::swap(buffer_, other.buffer_);
         std::swap(capacity_, other.capacity_);
     }
 
+    // Освобождает свой буфер и забирает буфер other.
+    // Аллокатор перенимается, только если он распространяется при перемещении
+    void StealBuffer(RawMemory& other) noexcept {
+        Deallocate(buffer_, capacity_);
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+            alloc_ = other.alloc_;
+        } else {
+            assert(alloc_ == other.alloc_);
+        }
+        buffer_ = std::exchange(other.buffer_, nullptr);
+        capacity_ = std::exchange(other.capacity_, 0);
+    }
+
+    // Меняет вместимость, сохраняя содержимое первых min(Capacity(), new_capacity) элементов.
+    // Аллокатор может нарастить блок на месте или перенести его страницами (mremap)
+    void Reallocate(size_t new_capacity) {
+        static_assert(CAN_REALLOCATE, "Reallocate requires trivially relocatable T and Allocator::reallocate");
+        if (buffer_ == nullptr) {
+            buffer_ = Allocate(new_capacity);
+        } else if (new_capacity == 0) {
+            Deallocate(buffer_, capacity_);
+            buffer_ = nullptr;
+        } else {
+            buffer_ = alloc_.reallocate(buffer_, capacity_, new_capacity);
+        }
+        capacity_ = new_capacity;
+    }
+
+    // Освобождает буфер и заменяет аллокатор (для propagate_on_container_copy_assignment)
+    void ResetAllocator(const Allocator& alloc) noexcept {
+        Deallocate(buffer_, capacity_);
+        buffer_ = nullptr;
+        capacity_ = 0;
+        alloc_ = alloc;
+    }
+
+    Allocator GetAllocator() const noexcept {
+        return alloc_;
+    }
+
     const T* GetAddress() const noexcept {
         return buffer_;
     }
@@ -81,22 +513,362 @@ public:
 
 private:
     // Выделяет сырую память под n элементов и возвращает указатель на неё
-    static T* Allocate(size_t n) {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+    T* Allocate(size_t n) {
+        T* buf = n != 0 ? AllocTraits::allocate(alloc_, n) : nullptr;
+        assert(reinterpret_cast<uintptr_t>(buf) % alignof(T) == 0);
+        return buf;
     }
 
-    // Освобождает сырую память, выделенную ранее по адресу buf при помощи Allocate
-    static void Deallocate(T* buf) noexcept {
-        operator delete(buf);
+    // Освобождает сырую память под n элементов, выделенную ранее по адресу buf при помощи Allocate
+    void Deallocate(T* buf, size_t n) noexcept {
+        if (buf != nullptr) {
+            AllocTraits::deallocate(alloc_, buf, n);
+        }
     }
 
+    Allocator alloc_ = Allocator();
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
 };// RawMemory
 
+// Поэлементные операции над сырой памятью, общие для контейнеров на RawMemory
+namespace detail {
+
+// Подсказка оптимизатору: сюда выполнение не доходит (как std::unreachable из C++23).
+// В отладочной сборке это проверяется assert'ом
+[[noreturn]] inline void Unreachable() noexcept {
+    assert(false);
+#if defined(__GNUC__)
+    __builtin_unreachable();
+#elif defined(_MSC_VER)
+    __assume(false);
+#else
+    std::abort();
+#endif
+}
+
+// Вызывает деструкторы n объектов массива по адресу buf.
+// Для тривиально разрушаемых T цикла нет вовсе
+template <typename T>
+void DestroyN(T* buf, size_t n) noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        for (size_t i = 0; i != n; ++i) {
+            buf[i].~T();
+        }
+    }
+}
+
+// Копирует n элементов из from в сырую память по адресу to
+template <typename T>
+void UninitializedCopyN(const T* from, size_t n, T* to) {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        if (n != 0) {
+            std::memcpy(to, from, n * sizeof(T));
+        }
+    } else {
+        std::uninitialized_copy_n(from, n, to);
+    }
+}
+
+// Переносит n элементов из from в сырую память по адресу to. Исходные элементы не разрушаются,
+// это делает вызывающий через DestroyRelocatedN после успешного переноса всех частей буфера.
+// Побайтно перемещаемые T (IsTriviallyRelocatable) переносятся одним memcpy, остальные перемещаются,
+// если перемещение noexcept (или копирования нет), иначе копируются
+template <typename T>
+void UninitializedRelocateN(T* from, size_t n, T* to) {
+    if constexpr (IsTriviallyRelocatable<T>::value) {
+        if (n != 0) {
+            std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+        }
+    } else if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+        std::uninitialized_move_n(from, n, to);
+    } else {
+        std::uninitialized_copy_n(from, n, to);
+    }
+}
+
+// Завершает перенос: разрушает n исходных элементов после UninitializedRelocateN.
+// Побайтный перенос уже сделал новые объекты владельцами, деструкторы старых не вызываются
+template <typename T>
+void DestroyRelocatedN(T* buf, size_t n) noexcept {
+    if constexpr (!IsTriviallyRelocatable<T>::value) {
+        DestroyN(buf, n);
+    }
+}
+
+// Сдвигает n побайтно перемещаемых элементов [pos, pos + n) на count позиций вправо одним memmove.
+// На месте [pos, pos + count) остаётся сырая память, за pos + n должно хватать сырой памяти
 template <typename T>
-class Vector {
+void OpenGap(T* pos, size_t n, size_t count) noexcept {
+    static_assert(IsTriviallyRelocatable<T>::value);
+    std::memmove(static_cast<void*>(pos + count), static_cast<const void*>(pos), n * sizeof(T));
+}
+
+// Обратно к OpenGap: n элементов [pos + count, pos + count + n) переезжают на pos,
+// сырая память (или уже разрушенные элементы) на их месте затирается
+template <typename T>
+void CloseGap(T* pos, size_t n, size_t count) noexcept {
+    static_assert(IsTriviallyRelocatable<T>::value);
+    std::memmove(static_cast<void*>(pos), static_cast<const void*>(pos + count), n * sizeof(T));
+}
+
+// Вставляет новый элемент в pos, сдвигая n элементов [pos, pos + n) вправо через OpenGap.
+// Аргументы могут ссылаться на сдвигаемый элемент, поэтому элемент строится до сдвига в сыром буфере
+// и переносится в дыру побайтно: ни одного перемещения
+template <typename T, typename... Args>
+void EmplaceIntoGap(T* pos, size_t n, Args&&... args) {
+    alignas(T) unsigned char slot[sizeof(T)];
+    T* temp = new (slot) T(std::forward<Args>(args)...);
+    OpenGap(pos, n, 1);
+    std::memcpy(static_cast<void*>(pos), static_cast<const void*>(temp), sizeof(T));
+}
+
+// Ограничение для перегрузок, принимающих диапазон итераторов: отсекает, например, Insert(pos, 3, 5)
+template <typename It>
+using RequireInputIterator = std::enable_if_t<std::is_convertible_v<
+    typename std::iterator_traits<It>::iterator_category, std::input_iterator_tag>>;
+
+// Размер диапазона можно узнать заранее, не проходя его
+template <typename It>
+inline constexpr bool IS_FORWARD_ITERATOR = std::is_convertible_v<
+    typename std::iterator_traits<It>::iterator_category, std::forward_iterator_tag>;
+
+}  // namespace detail
+
+// Тег конструктора Vector(size, DEFAULT_INIT): элементы инициализируются по умолчанию, а не значением,
+// так что тривиально конструируемые T (числа, POD) остаются неинициализированными
+struct DefaultInit {
+    explicit DefaultInit() = default;
+};
+inline constexpr DefaultInit DEFAULT_INIT{};
+
+// Политики роста. NextCapacity получает текущую вместимость, требуемое число элементов
+// и размер элемента и возвращает вместимость нового буфера (не меньше required)
+
+// Удвоение: меньше реаллокаций ценой до половины неиспользуемого буфера
+struct DoublingGrowth {
+    static size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        return std::max(required, capacity == 0 ? 1 : capacity * 2);
+    }
+};
+
+// Рост в 1.5 раза: экономнее по памяти, и освобождённые блоки со временем можно переиспользовать
+struct OneAndHalfGrowth {
+    static size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        return std::max(required, capacity < 2 ? capacity + 1 : capacity + capacity / 2);
+    }
+};
+
+// Выделяет ли аллокатор память прямо через malloc, так что размеры его блоков подчиняются модели
+// MallocSizeClassGrowth. std::allocator в libstdc++ идёт через operator new, то есть через malloc,
+// пока operator new не заменён. Выравнивающие, huge page и pmr-аллокаторы сюда не входят
+template <typename Allocator>
+struct IsMallocBacked : std::false_type {};
+
+template <typename T>
+struct IsMallocBacked<std::allocator<T>> : std::true_type {};
+
+// Блоки от MmapThreshold и больше ReallocAllocator берёт через mmap сам: там модель даёт нижнюю
+// оценку (хвост до страницы), так что вместимость всё равно не превышает выделенного
+template <typename T, size_t MmapThreshold>
+struct IsMallocBacked<ReallocAllocator<T, MmapThreshold>> : std::true_type {};
+
+// Округляет вместимость Base до размера блока, который malloc из glibc всё равно выделит:
+// хвост, который иначе пропал бы зря, становится вместимостью.
+// Блок из кучи — чанк, кратный MALLOC_ALIGNMENT, с заголовком SIZE_SZ. Блок от mmap — целые страницы
+// с заголовком чанка и ещё SIZE_SZ перед ним. Порог mmap в glibc плавает от 128 КиБ до 32 МиБ,
+// так что между ними блок может прийти откуда угодно, и берётся меньшая оценка — кучевая.
+// Годится только для аллокаторов поверх malloc (IsMallocBacked), контейнеры проверяют это static_assert'ом
+template <typename Base = DoublingGrowth>
+struct MallocSizeClassGrowth {
+    static constexpr bool REQUIRES_MALLOC_ALLOCATOR = true;
+
+    static size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        const size_t base_capacity = Base::NextCapacity(capacity, required, element_size);
+        if (base_capacity > (SIZE_MAX / 2) / element_size) {
+            return base_capacity;
+        }
+        return UsableBytes(base_capacity * element_size) / element_size;
+    }
+
+private:
+    // Константы malloc/malloc.c для 64-битной glibc
+    static constexpr size_t SIZE_SZ = sizeof(size_t);
+    static constexpr size_t MALLOC_ALIGNMENT = std::max(2 * SIZE_SZ, alignof(std::max_align_t));
+    static constexpr size_t MIN_CHUNK_SIZE = (4 * SIZE_SZ + MALLOC_ALIGNMENT - 1) / MALLOC_ALIGNMENT * MALLOC_ALIGNMENT;
+    static constexpr size_t MMAP_THRESHOLD_MAX = 4 * 1024 * 1024 * sizeof(long);
+
+    static size_t RoundUp(size_t bytes, size_t alignment) noexcept {
+        return (bytes + alignment - 1) / alignment * alignment;
+    }
+
+    static size_t PageSize() noexcept {
+#ifdef __linux__
+        static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return page_size;
+#else
+        return 4096;
+#endif
+    }
+
+    static size_t UsableBytes(size_t bytes) noexcept {
+        // request2size: размер чанка под bytes байт вместе с заголовком
+        const size_t chunk = std::max(MIN_CHUNK_SIZE, RoundUp(bytes + SIZE_SZ, MALLOC_ALIGNMENT));
+        if (bytes < MMAP_THRESHOLD_MAX) {
+            return chunk - SIZE_SZ;
+        }
+        // Наибольший запрос, чанк которого ещё помещается в те же страницы
+        const size_t mapped = RoundUp(chunk + SIZE_SZ, PageSize());
+        return (mapped - SIZE_SZ) / MALLOC_ALIGNMENT * MALLOC_ALIGNMENT - SIZE_SZ;
+    }
+};
+
+namespace detail {
+
+// Политика роста, которая моделирует блоки malloc (MallocSizeClassGrowth, в том числе как база)
+template <typename GrowthPolicy, typename = void>
+inline constexpr bool REQUIRES_MALLOC_ALLOCATOR = false;
+
+template <typename GrowthPolicy>
+inline constexpr bool REQUIRES_MALLOC_ALLOCATOR<GrowthPolicy, std::void_t<decltype(GrowthPolicy::REQUIRES_MALLOC_ALLOCATOR)>> =
+    GrowthPolicy::REQUIRES_MALLOC_ALLOCATOR;
+
+}  // namespace detail
+
+// Рост по Base плюс авто-сжатие: когда после удаления элементов их остаётся меньше
+// Capacity() / Divisor, буфер ужимается до 2 * Size() (но не меньше MinCapacity).
+// После сжатия буфер заполнен наполовину, и следующая реаллокация случится, только если вектор
+// вырастет вдвое или снова опустится до 1 / Divisor, так что колебания у порога не гоняют память туда-сюда
+template <typename Base = DoublingGrowth, size_t Divisor = 4, size_t MinCapacity = 16>
+struct ShrinkOnUnderflow : Base {
+    static_assert(Divisor > 2, "Shrink threshold must stay below the half-full target, otherwise it thrashes");
+
+    // Вместимость после удаления элементов; capacity, если сжимать не нужно
+    static size_t ShrinkCapacity(size_t capacity, size_t size, size_t /*element_size*/) noexcept {
+        if (capacity <= MinCapacity || size >= capacity / Divisor) {
+            return capacity;
+        }
+        return std::max(MinCapacity, size * 2);
+    }
+};
+
+// Определяет, умеет ли политика роста сжимать буфер (метод ShrinkCapacity)
+template <typename GrowthPolicy, typename = void>
+struct HasShrinkCapacity : std::false_type {};
+
+template <typename GrowthPolicy>
+struct HasShrinkCapacity<GrowthPolicy, std::void_t<decltype(GrowthPolicy::ShrinkCapacity(
+        size_t{}, size_t{}, size_t{}))>> : std::true_type {};
+
+// Счётчики Vector включаются флагом компиляции -DVECTOR_ENABLE_STATS.
+// Без него учёт вырезается целиком: ни кода, ни лишних байт в Vector
+#ifdef VECTOR_ENABLE_STATS
+inline constexpr bool VECTOR_STATS_ENABLED = true;
+#else
+inline constexpr bool VECTOR_STATS_ENABLED = false;
+#endif
+
+// Что произошло с конкретным вектором с момента его создания (или ResetStats)
+struct VectorStats {
+    size_t reallocations = 0;     // замены непустого буфера на новый (рост, сжатие)
+    size_t bytes_allocated = 0;   // суммарный объём всех выделенных буферов
+    size_t bytes_relocated = 0;   // объём элементов, перенесённых из старого буфера в новый
+    size_t peak_capacity = 0;     // наибольшая вместимость за время жизни
+    size_t elements_moved = 0;    // элементы, перемещённые самим контейнером (перенос, перемещение вектора)
+    size_t elements_copied = 0;   // элементы, скопированные самим контейнером (копия вектора, перенос без noexcept-move)
+    size_t elements_shifted = 0;  // элементы, сдвинутые внутри буфера в Emplace/Insert/Erase
+};
+
+namespace detail {
+
+// Учёт для VectorStats. Vector наследуется от него закрыто, так что выключенный учёт
+// не занимает места (пустая база), а его методы — пустые inline-функции
+template <typename T, bool Enabled = VECTOR_STATS_ENABLED>
+class StatsRecorder {
+protected:
+    VectorStats GetStatsImpl() const noexcept {
+        return {};
+    }
+    void ResetStatsImpl() noexcept {
+    }
+    void RecordAllocation(size_t /*capacity*/) noexcept {
+    }
+    void RecordBufferChange(size_t /*old_capacity*/, size_t /*new_capacity*/, size_t /*relocated*/) noexcept {
+    }
+    void RecordMoves(size_t /*n*/) noexcept {
+    }
+    void RecordCopies(size_t /*n*/) noexcept {
+    }
+    void RecordShift(size_t /*n*/) noexcept {
+    }
+};
+
+template <typename T>
+class StatsRecorder<T, true> {
+protected:
+    VectorStats GetStatsImpl() const noexcept {
+        return stats_;
+    }
+
+    void ResetStatsImpl() noexcept {
+        stats_ = VectorStats{};
+    }
+
+    // Выделен буфер под capacity элементов
+    void RecordAllocation(size_t capacity) noexcept {
+        stats_.bytes_allocated += capacity * sizeof(T);
+        stats_.peak_capacity = std::max(stats_.peak_capacity, capacity);
+    }
+
+    // Буфер на old_capacity элементов заменён новым, relocated элементов перенесено (UninitializedRelocateN)
+    void RecordBufferChange(size_t old_capacity, size_t new_capacity, size_t relocated) noexcept {
+        if (old_capacity != 0) {
+            ++stats_.reallocations;
+        }
+        RecordAllocation(new_capacity);
+        stats_.bytes_relocated += relocated * sizeof(T);
+        if constexpr (IsTriviallyRelocatable<T>::value || std::is_nothrow_move_constructible_v<T>
+                      || !std::is_copy_constructible_v<T>) {
+            RecordMoves(relocated);
+        } else {
+            RecordCopies(relocated);
+        }
+    }
+
+    void RecordMoves(size_t n) noexcept {
+        stats_.elements_moved += n;
+    }
+
+    void RecordCopies(size_t n) noexcept {
+        stats_.elements_copied += n;
+    }
+
+    void RecordShift(size_t n) noexcept {
+        stats_.elements_shifted += n;
+    }
+
+private:
+    VectorStats stats_;
+};
+
+}  // namespace detail
+
+// Элементы конструируются размещающим new прямо в памяти RawMemory,
+// аллокатор отвечает только за выделение и освобождение буфера.
+// GrowthPolicy задаёт вместимость при росте в EmplaceBack/Emplace (Reserve выделяет ровно запрошенное),
+// а если у неё есть ShrinkCapacity (см. ShrinkOnUnderflow) — и сжатие после PopBack/Erase/Resize.
+// С такой политикой удаление элементов может перевыделить буфер и сделать недействительными все итераторы
+// С -DVECTOR_ENABLE_STATS каждый вектор ведёт VectorStats, см. GetStats
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth>
+class Vector : private detail::StatsRecorder<T> {
+    static_assert(!detail::REQUIRES_MALLOC_ALLOCATOR<GrowthPolicy> || IsMallocBacked<Allocator>::value,
+                  "MallocSizeClassGrowth models glibc malloc blocks and needs a malloc-backed allocator");
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using Stats = detail::StatsRecorder<T>;
+
 public:
+    using value_type = T;
+    using allocator_type = Allocator;
     using iterator = T*;
     using const_iterator = const T*;
 
@@ -121,13 +893,16 @@ public:
 
 
     Vector() = default;
+
+    explicit Vector(const Allocator& alloc) noexcept
+        : data_(alloc) {}
 /*
 Этот конструктор сначала выделяет в сырой памяти буфер, достаточный для хранения  элементов в количестве, равном size.
 Затем конструирует в сырой памяти элементы массива.
 Для этого он вызывает их конструктор по умолчанию, используя размещающий оператор new.
 */
-    explicit Vector(size_t size)
-            : data_(size)
+    explicit Vector(size_t size, const Allocator& alloc = Allocator())
+            : data_(size, alloc)
             , size_(size)  //
         {
 //            size_t i = 0;
@@ -143,6 +918,7 @@ public:
 //                throw;
 //            }
             std::uninitialized_value_construct_n(data_.GetAddress(), size);
+            Stats::RecordAllocation(size);
         }
 //    explicit Vector(size_t size)
 //        : data_(Allocate(size))
@@ -164,6 +940,26 @@ public:
 //            throw;
 //        }
 //    }
+    // Без обнуления: буфер под size элементов, которые тут же перезапишут (read(), декодер и т.п.)
+    Vector(size_t size, DefaultInit, const Allocator& alloc = Allocator())
+        : data_(size, alloc)
+    {
+        std::uninitialized_default_construct_n(data_.GetAddress(), size);
+        size_ = size;
+        Stats::RecordAllocation(size);
+    }
+
+    // Для forward-итераторов память выделяется один раз и ровно под диапазон
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    Vector(InputIt first, InputIt last, const Allocator& alloc = Allocator())
+        : data_(alloc)
+    {
+        if constexpr (detail::IS_FORWARD_ITERATOR<InputIt>) {
+            Reserve(static_cast<size_t>(std::distance(first, last)));
+        }
+        Append(first, last);
+    }
+
 /*
 Чтобы создать копию контейнера Vector, выделим память под нужное количество элементов,
 а затем сконструируем в ней копию элементов оригинального контейнера, используя функцию CopyConstruct.
@@ -191,7 +987,11 @@ public:
 //            }
 //        }
     Vector(const Vector& other)
-        : data_(other.size_)
+        : Vector(other, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator())) {
+    }
+
+    Vector(const Vector& other, const Allocator& alloc)
+        : data_(other.size_, alloc)
         , size_(other.size_)  //
     {
 //        size_t i = 0;
@@ -204,51 +1004,85 @@ public:
 //            //Deallocate(data_);
 //            throw;
 //        }
-        std::uninitialized_copy_n(other.data_.GetAddress(), size_, data_.GetAddress());
-
+        detail::UninitializedCopyN(other.data_.GetAddress(), size_, data_.GetAddress());
+        Stats::RecordAllocation(size_);
+        Stats::RecordCopies(size_);
     }
 
     Vector& operator=(const Vector& rhs) {
         if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                if (data_.GetAllocator() != rhs.data_.GetAllocator()) {
+                    // Старый буфер нужно вернуть тому аллокатору, который его выделил
+                    std::destroy_n(data_.GetAddress(), size_);
+                    size_ = 0;
+                    data_.ResetAllocator(rhs.data_.GetAllocator());
+                }
+            }
             if (size_ >= rhs.Size()) {
                 size_t delta = size_ - rhs.size_;
                 std::copy(rhs.data_.GetAddress(), rhs.data_.GetAddress() + rhs.size_, data_.GetAddress());
-                std::destroy_n(data_.GetAddress() + rhs.size_, delta);
+                detail::DestroyN(data_.GetAddress() + rhs.size_, delta);
                 size_ = rhs.size_;
             }
             else {
                 if (data_.Capacity() < rhs.size_) {
-                    Vector rhs_copy(rhs);
+                    Vector rhs_copy(rhs, data_.GetAllocator());
+                    Stats::RecordBufferChange(data_.Capacity(), rhs.size_, 0);
                     Swap(rhs_copy);
                 }
                 else {
 
                     size_t delta = rhs.size_ - size_;
                     std::copy(rhs.data_.GetAddress(), rhs.data_.GetAddress() + size_, data_.GetAddress());
-                    std::uninitialized_copy_n(rhs.data_.GetAddress() + size_, delta, data_.GetAddress() + size_);
+                    detail::UninitializedCopyN(rhs.data_.GetAddress() + size_, delta, data_.GetAddress() + size_);
                     size_ = rhs.size_;
                 }
             }
+            Stats::RecordCopies(rhs.size_);
         }
         return *this;
     }
 
+    // O(1) и без обращений к куче: забираем буфер other вместе с элементами
     Vector(Vector&& other) noexcept
-//        : data_(std::move(other.data_))
-//        , size_(other.size_)
+        : data_(std::move(other.data_))
+        , size_(std::exchange(other.size_, 0)) {}
+
+    Vector(Vector&& other, const Allocator& alloc)
+        : data_(alloc)
     {
-        data_.Swap(other.data_);
-        size_ = other.size_;
-        other.size_ = 0;
-        //std::uninitialized_move_n(other.data_.GetAddress(), size_, data_.GetAddress());
-        //size_ = other.size_;
+        if (alloc == other.data_.GetAllocator()) {
+            data_.Swap(other.data_);
+            std::swap(size_, other.size_);
+        } else {
+            // Чужой аллокатор не может освободить память other, поэтому переносим поэлементно
+            RawMemory<T, Allocator> new_data(other.size_, alloc);
+            std::uninitialized_move_n(other.data_.GetAddress(), other.size_, new_data.GetAddress());
+            data_.Swap(new_data);
+            size_ = other.size_;
+            Stats::RecordAllocation(size_);
+            Stats::RecordMoves(size_);
+        }
     }
 
-    Vector& operator=(Vector&& rhs) noexcept {
+    Vector& operator=(Vector&& rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                             || AllocTraits::is_always_equal::value) {
         if (this != &rhs) {
-            size_ = 0;
-            data_ = RawMemory<T>();
-            this->Swap(rhs);
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value
+                          || AllocTraits::is_always_equal::value) {
+                StealFrom(rhs);
+            } else if (data_.GetAllocator() == rhs.data_.GetAllocator()) {
+                StealFrom(rhs);
+            } else {
+                // Аллокаторы различны и не распространяются: буфер rhs забрать нельзя
+                std::destroy_n(data_.GetAddress(), size_);
+                size_ = 0;
+                Reserve(rhs.size_);
+                std::uninitialized_move_n(rhs.data_.GetAddress(), rhs.size_, data_.GetAddress());
+                size_ = rhs.size_;
+                Stats::RecordMoves(size_);
+            }
         }
         return *this;
     }
@@ -257,6 +1091,20 @@ public:
         data_.Swap(other.data_);
         std::swap(size_, other.size_);
     }
+
+    Allocator GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    // Счётчики этого вектора; без VECTOR_ENABLE_STATS всегда нулевые.
+    // Перемещение и обмен их не переносят: статистика принадлежит объекту, а не буферу
+    VectorStats GetStats() const noexcept {
+        return Stats::GetStatsImpl();
+    }
+
+    void ResetStats() noexcept {
+        Stats::ResetStatsImpl();
+    }
 /*
 Сначала необходимо вызвать деструкторы у size_ элементов массива, используя функцию DestroyN.
 Затем нужно освободить выделенную динамическую память, используя функцию Deallocate.
@@ -267,8 +1115,7 @@ public:
 
 */
     ~Vector() {
-        //DestroyN(data_.GetAddress(), size_);
-        std::destroy_n(data_.GetAddress(), size_);
+        detail::DestroyN(data_.GetAddress(), size_);
     }
 //    ~Vector() {
 //        DestroyN(data_, size_);
@@ -282,42 +1129,15 @@ public:
         if (new_capacity <= data_.Capacity()) {
             return;
         }
+        Reallocate(new_capacity);
+    }
 
-        RawMemory<T> new_data(new_capacity);// = Allocate(new_capacity);
-//        size_t i = 0;
-//        try {
-//            for (; i != size_; ++i) {
-//                CopyConstruct(new_data + i, data_[i]); // можно без гетадресс походу изза оператор +
-//            }
-//        } catch (...) {
-//            DestroyN(new_data.GetAddress(), i);
-//            throw;
-//        }
-
-//        DestroyN(data_.GetAddress(), size_);
-
-        // Конструируем элементы в new_data, копируя их из data_
-//        std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
-        //уместнее будет использовать перемещение
-        //std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
-
-        // constexpr оператор if Шаблоны std::is_copy_constructible_v и std::is_nothrow_move_constructible_v
-        //помогают узнать, есть ли у типа копирующий конструктор и noexcept-конструктор перемещения.
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            //уместнее будет использовать перемещение
-            std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
-        } else {
-            // Конструируем элементы в new_data, копируя их из data_ если
-            std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
+    // Отдаёт лишнюю вместимость: буфер перевыделяется ровно под Size() элементов,
+    // у пустого вектора память освобождается совсем
+    void ShrinkToFit() {
+        if (size_ < data_.Capacity()) {
+            Reallocate(size_);
         }
-
-        // Разрушаем элементы в data_
-        std::destroy_n(data_.GetAddress(), size_);
-        // Избавляемся от старой сырой памяти, обменивая её на новую
-        data_.Swap(new_data);
-        // При выходе из метода старая память будет возвращена в кучу
-//        data_ = new_data;
-//        capacity_ = new_capacity;
     }
 
     void Resize(size_t new_size) {
@@ -327,6 +1147,9 @@ public:
 
         else if (size_ > new_size) {
             std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
+            size_ = new_size;
+            ShrinkIfUnderused();
+            return;
         }
         else {
             Reserve(new_size);
@@ -335,19 +1158,151 @@ public:
         size_ = new_size;
     }
 
-    template <typename... Args>
-    T& EmplaceBack(Args&&... args) {
-        if (size_ == Capacity()) {
-            RawMemory<T> new_data((size_ == 0) ? 1 : 2 * size_);
+    // Как Resize, но новые элементы инициализируются по умолчанию: для тривиально
+    // конструируемых T память не трогается вовсе, для остальных вызывается конструктор по умолчанию
+    void ResizeDefaultInit(size_t new_size) {
+        if (new_size < size_) {
+            detail::DestroyN(data_.GetAddress() + new_size, size_ - new_size);
+        } else if (new_size > size_) {
+            Reserve(new_size);
+            std::uninitialized_default_construct_n(data_.GetAddress() + size_, new_size - size_);
+        }
+        size_ = new_size;
+        ShrinkIfUnderused();
+    }
+
+    // Меняет размер, не выполняя над новыми элементами никакой работы. Содержимое новых
+    // элементов не определено, пока его не перезапишут. Только для тривиальных T
+    void ResizeUninitialized(size_t new_size) {
+        static_assert(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>,
+                      "ResizeUninitialized requires a trivial element type, use ResizeDefaultInit");
+        Reserve(new_size);
+        size_ = new_size;
+        ShrinkIfUnderused();
+    }
+
+    // Разрушает все элементы, вместимость сохраняется даже при авто-сжатии (вектор обычно тут же заполняют заново)
+    void Clear() noexcept {
+        detail::DestroyN(data_.GetAddress(), size_);
+        size_ = 0;
+    }
+
+    // Дописывает [first, last) в конец. Для forward-итераторов вместимость наращивается не больше
+    // одного раза (по GrowthPolicy, чтобы серия Append оставалась амортизированно линейной).
+    // Размер однопроходного диапазона заранее неизвестен: size_hint позволяет зарезервировать место сразу.
+    // Диапазон не должен указывать в сам вектор, для этого есть Append(const Vector&)
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    void Append(InputIt first, InputIt last, size_t size_hint = 0) {
+        if constexpr (detail::IS_FORWARD_ITERATOR<InputIt>) {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            ReserveForAppend(count);
+            std::uninitialized_copy(first, last, end());
+            size_ += count;
+        } else {
+            ReserveForAppend(size_hint);
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+        }
+    }
 
-            new (new_data.GetAddress() + size_) T(std::forward<Args>(args)...);
+    void Append(const Vector& other) {
+        // other может оказаться самим вектором: источник берём по индексам уже после реаллокации
+        const size_t count = other.size_;
+        ReserveForAppend(count);
+        detail::UninitializedCopyN(other.data_.GetAddress(), count, data_.GetAddress() + size_);
+        size_ += count;
+    }
+
+    // Элементы other переносятся (для тривиально копируемых T — одним memcpy), other становится пустым.
+    // Если пуст сам вектор, буфер other забирается целиком
+    void Append(Vector&& other) {
+        if (this == &other) {
+            Append(static_cast<const Vector&>(other));
+            return;
+        }
+        if (size_ == 0 && Capacity() <= other.Capacity()
+            && data_.GetAllocator() == other.data_.GetAllocator()) {
+            Swap(other);
+            return;
+        }
+        ReserveForAppend(other.size_);
+        detail::UninitializedRelocateN(other.data_.GetAddress(), other.size_, data_.GetAddress() + size_);
+        detail::DestroyRelocatedN(other.data_.GetAddress(), other.size_);
+        Stats::RecordMoves(other.size_);
+        size_ += std::exchange(other.size_, 0);
+    }
 
-            if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-                std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
+    // Заменяет содержимое диапазоном [first, last). Существующие элементы переприсваиваются;
+    // если диапазон не помещается, память выделяется один раз и ровно под него
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    void Assign(InputIt first, InputIt last, size_t size_hint = 0) {
+        if constexpr (detail::IS_FORWARD_ITERATOR<InputIt>) {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            if (count > Capacity()) {
+                Vector new_vector(first, last, data_.GetAllocator());
+                Swap(new_vector);
+            } else if (count <= size_) {
+                iterator new_end = std::copy(first, last, begin());
+                detail::DestroyN(new_end, size_ - count);
+                size_ = count;
             } else {
-                std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
+                InputIt mid = first;
+                std::advance(mid, size_);
+                std::copy(first, mid, begin());
+                std::uninitialized_copy(mid, last, end());
+                size_ = count;
+            }
+        } else {
+            Clear();
+            Append(first, last, size_hint);
+        }
+    }
+
+    void Assign(size_t count, const T& value) {
+        if (count > Capacity()) {
+            // value может быть элементом вектора, поэтому старый буфер освобождается последним
+            Vector new_vector(data_.GetAllocator());
+            new_vector.Reserve(count);
+            std::uninitialized_fill_n(new_vector.data_.GetAddress(), count, value);
+            new_vector.size_ = count;
+            Swap(new_vector);
+        } else if (count <= size_) {
+            std::fill_n(begin(), count, value);
+            detail::DestroyN(begin() + count, size_ - count);
+            size_ = count;
+        } else {
+            std::fill_n(begin(), size_, value);
+            std::uninitialized_fill_n(end(), count - size_, value);
+            size_ = count;
+        }
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if constexpr (RawMemory<T, Allocator>::CAN_REALLOCATE) {
+            if (size_ == Capacity()) {
+                // args могут ссылаться на элемент вектора, а Reallocate может освободить старый блок
+                T temp(std::forward<Args>(args)...);
+                Reallocate(GrowthCapacity(size_ + 1));
+                new (data_.GetAddress() + size_) T(std::move(temp));
+                ++size_;
+                return *(data_.GetAddress() + size_ - 1);
             }
-            std::destroy_n(data_.GetAddress(), size_);
+        }
+
+        if (size_ == Capacity()) {
+            RawMemory<T, Allocator> new_data(GrowthCapacity(size_ + 1), data_.GetAllocator());
+
+            T* new_elem = new (new_data.GetAddress() + size_) T(std::forward<Args>(args)...);
+            try {
+                detail::UninitializedRelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+            } catch (...) {
+                detail::DestroyN(new_elem, 1);
+                throw;
+            }
+            detail::DestroyRelocatedN(data_.GetAddress(), size_);
+            Stats::RecordBufferChange(data_.Capacity(), new_data.Capacity(), size_);
             data_.Swap(new_data);
 
         } else {
@@ -368,7 +1323,7 @@ public:
 //            new (data_.GetAddress()) T(std::forward<S>(value));
 //        }
 //        else {
-//            RawMemory<T> new_data(size_ * 2);
+//            RawMemory<T, Allocator> new_data(size_ * 2, data_.GetAllocator());
 //            new (new_data + size_) T(std::forward<S>(value));
 //            if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
 //                std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
@@ -394,53 +1349,35 @@ public:
         else {
             const size_t left_delta = pos - begin();
 
-            if (Capacity() > size_) {
+            if constexpr (RawMemory<T, Allocator>::CAN_REALLOCATE) {
+                if (Capacity() == size_) {
+                    T temp(std::forward<Args>(args)...);
+                    Reallocate(GrowthCapacity(size_ + 1));
+                    return Emplace(begin() + left_delta, std::move(temp));
+                }
+            }
 
-                T temp = T(std::forward<Args>(args)...);
-                std::uninitialized_move_n(end() - 1, 1, end());
-                ++size_;
-                std::move_backward(begin() + left_delta, end() - 2, end() - 1);
+            if (Capacity() > size_) {
+                Stats::RecordShift(size_ - left_delta);
                 iterator it_pos = begin() + left_delta;
-                *it_pos = std::move(temp);
+                if constexpr (IsTriviallyRelocatable<T>::value) {
+                    detail::EmplaceIntoGap(it_pos, size_ - left_delta, std::forward<Args>(args)...);
+                    ++size_;
+                } else {
+                    T temp = T(std::forward<Args>(args)...);
+                    std::uninitialized_move_n(end() - 1, 1, end());
+                    ++size_;
+                    std::move_backward(it_pos, end() - 2, end() - 1);
+                    *it_pos = std::move(temp);
+                }
                 return it_pos;
             }
 
             else {
-                RawMemory<T> new_data(size_ * 2);
+                RawMemory<T, Allocator> new_data(GrowthCapacity(size_ + 1), data_.GetAllocator());
                 iterator it_pos_new_data = new_data.GetAddress() + left_delta;
                 new(it_pos_new_data) T(std::forward<Args>(args)...);
-                try {
-                    if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-                        std::uninitialized_move_n(data_.GetAddress(), left_delta, new_data.GetAddress());
-                    }
-                    else {
-                        std::uninitialized_copy_n(data_.GetAddress(), left_delta, new_data.GetAddress());
-                    }
-                }
-                catch (...) {
-                    std::destroy_n(new_data + left_delta, 1);
-                    new_data.~RawMemory();
-                    throw;
-                }
-
-                try {
-                    if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-                        std::uninitialized_move_n(data_.GetAddress() + left_delta, size_ - left_delta, new_data.GetAddress() + left_delta + 1);
-                    }
-                    else {
-                        std::uninitialized_copy_n(data_.GetAddress() + left_delta, size_ - left_delta, new_data.GetAddress() + left_delta + 1);
-                    }
-
-                }
-                catch (...) {
-                    //std::destroy_n(new_data, left_delta);
-                    new_data.~RawMemory();
-                    throw;
-                }
-
-                std::destroy_n(data_.GetAddress(), size_);
-                data_.Swap(new_data);
-                ++size_;
+                RelocateAroundGap(new_data, left_delta, 1);
 
                 iterator it_pos = begin() + left_delta;
                 return it_pos;
@@ -449,12 +1386,34 @@ public:
     }
 
     iterator Erase(const_iterator pos) /*noexcept(std::is_nothrow_move_assignable_v<T>)*/ {
-        assert(begin() <= pos && pos <= end());
-        iterator new_pos = begin() + (pos - cbegin());
-        std::move(new_pos + 1, end(), new_pos);
-        std::destroy_n(end() - 1, 1);
-        --size_;
-        return new_pos;
+        assert(begin() <= pos && pos < end());
+        return Erase(pos, pos + 1);
+    }
+
+    // Удаляет [first, last): хвост сдвигается одним проходом, освободившийся конец разрушается одним DestroyN.
+    // Побайтно перемещаемые T не переприсваиваются вовсе: удалённые разрушаются, а хвост переезжает
+    // на их место одним memmove
+    iterator Erase(const_iterator first, const_iterator last) {
+        assert(cbegin() <= first && first <= last && last <= cend());
+        const size_t index = first - cbegin();
+        iterator it_first = begin() + index;
+        iterator it_last = begin() + (last - cbegin());
+        if (it_first != it_last) {
+            const size_t tail = static_cast<size_t>(end() - it_last);
+            Stats::RecordShift(tail);
+            if constexpr (IsTriviallyRelocatable<T>::value) {
+                const size_t count = static_cast<size_t>(it_last - it_first);
+                detail::DestroyN(it_first, count);
+                detail::CloseGap(it_first, tail, count);
+                size_ = index + tail;
+            } else {
+                iterator new_end = std::move(it_last, end(), it_first);
+                detail::DestroyN(new_end, static_cast<size_t>(end() - new_end));
+                size_ = static_cast<size_t>(new_end - begin());
+            }
+            ShrinkIfUnderused();
+        }
+        return begin() + index;
     }
 
     iterator Insert(const_iterator pos, const T& value) {
@@ -465,6 +1424,131 @@ public:
         return Emplace(pos, std::move(value));
     }
 
+    // Вставляет count копий value перед pos: хвост сдвигается один раз, реаллокация не больше одной
+    iterator Insert(const_iterator pos, size_t count, const T& value) {
+        assert(cbegin() <= pos && pos <= cend());
+        const size_t index = pos - cbegin();
+        if (count == 0) {
+            return begin() + index;
+        }
+
+        if constexpr (RawMemory<T, Allocator>::CAN_REALLOCATE) {
+            if (size_ + count > Capacity()) {
+                // value может ссылаться на элемент вектора, а Reallocate может освободить старый блок
+                const T temp(value);
+                Reallocate(GrowthCapacity(size_ + count));
+                return Insert(begin() + index, count, temp);
+            }
+        }
+
+        if (size_ + count > Capacity()) {
+            RawMemory<T, Allocator> new_data(GrowthCapacity(size_ + count), data_.GetAllocator());
+            std::uninitialized_fill_n(new_data.GetAddress() + index, count, value);
+            RelocateAroundGap(new_data, index, count);
+            return begin() + index;
+        }
+
+        // value может ссылаться на элемент, который сейчас сдвинется
+        const T temp(value);
+        T* it_pos = begin() + index;
+        T* old_end = end();
+        const size_t elems_after = size_ - index;
+        Stats::RecordShift(elems_after);
+        if constexpr (IsTriviallyRelocatable<T>::value) {
+            detail::OpenGap(it_pos, elems_after, count);
+            try {
+                std::uninitialized_fill_n(it_pos, count, temp);
+            } catch (...) {
+                detail::CloseGap(it_pos, elems_after, count);
+                throw;
+            }
+            size_ += count;
+        } else if (elems_after > count) {
+            std::uninitialized_move_n(old_end - count, count, old_end);
+            size_ += count;
+            std::move_backward(it_pos, old_end - count, old_end);
+            std::fill_n(it_pos, count, temp);
+        } else {
+            std::uninitialized_fill_n(old_end, count - elems_after, temp);
+            size_ += count - elems_after;
+            std::uninitialized_move_n(it_pos, elems_after, end());
+            size_ += elems_after;
+            std::fill_n(it_pos, elems_after, temp);
+        }
+        return it_pos;
+    }
+
+    // Вставляет [first, last) перед pos. Для forward-итераторов размер известен заранее:
+    // хвост сдвигается один раз, реаллокация не больше одной.
+    // Однопроходный диапазон дописывается в конец и поворачивается на место.
+    // Диапазон не должен указывать в сам вектор
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        assert(cbegin() <= pos && pos <= cend());
+        const size_t index = pos - cbegin();
+
+        if constexpr (!detail::IS_FORWARD_ITERATOR<InputIt>) {
+            const size_t old_size = size_;
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+            Stats::RecordShift(old_size - index);
+            std::rotate(begin() + index, begin() + old_size, end());
+            return begin() + index;
+        } else {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            if (count == 0) {
+                return begin() + index;
+            }
+
+            if constexpr (RawMemory<T, Allocator>::CAN_REALLOCATE) {
+                if (size_ + count > Capacity()) {
+                    Reallocate(GrowthCapacity(size_ + count));
+                }
+            }
+
+            if (size_ + count > Capacity()) {
+                RawMemory<T, Allocator> new_data(GrowthCapacity(size_ + count), data_.GetAllocator());
+                std::uninitialized_copy(first, last, new_data.GetAddress() + index);
+                RelocateAroundGap(new_data, index, count);
+                return begin() + index;
+            }
+
+            T* it_pos = begin() + index;
+            T* old_end = end();
+            const size_t elems_after = size_ - index;
+            Stats::RecordShift(elems_after);
+            if constexpr (IsTriviallyRelocatable<T>::value) {
+                detail::OpenGap(it_pos, elems_after, count);
+                try {
+                    std::uninitialized_copy(first, last, it_pos);
+                } catch (...) {
+                    detail::CloseGap(it_pos, elems_after, count);
+                    throw;
+                }
+                size_ += count;
+            } else if (elems_after > count) {
+                std::uninitialized_move_n(old_end - count, count, old_end);
+                size_ += count;
+                std::move_backward(it_pos, old_end - count, old_end);
+                std::copy(first, last, it_pos);
+            } else {
+                InputIt mid = first;
+                std::advance(mid, elems_after);
+                std::uninitialized_copy(mid, last, old_end);
+                size_ += count - elems_after;
+                std::uninitialized_move_n(it_pos, elems_after, end());
+                size_ += elems_after;
+                std::copy(first, mid, it_pos);
+            }
+            return it_pos;
+        }
+    }
+
+    iterator Insert(const_iterator pos, std::initializer_list<T> values) {
+        return Insert(pos, values.begin(), values.end());
+    }
+
 /* //или один с forward ссылкой? ( вопрос ревьюэру, пушбек так же? )
     template <typename S>
     void Insert(const_iterator pos, S&& value) {
@@ -478,6 +1562,7 @@ public:
         T* deleted = data_.GetAddress() + size_ - 1;
         deleted->~T();
         --size_;
+        ShrinkIfUnderused();
     }
 
     size_t Size() const noexcept {
@@ -528,13 +1613,6 @@ private: //methods
 //        operator delete(buf);
 //    }
 
-    // Вызывает деструкторы n объектов массива по адресу buf
-    static void DestroyN(T* buf, size_t n) noexcept {
-        for (size_t i = 0; i != n; ++i) {
-            Destroy(buf + i);
-        }
-    }
-
     // Создаёт копию объекта elem в сырой памяти по адресу buf
     static void CopyConstruct(T* buf, const T& elem) {
         new (buf) T(elem);
@@ -545,13 +1623,200 @@ private: //methods
         buf->~T();
     }
 
+    // Готовит место под count новых элементов в конце: не больше одной реаллокации
+    void ReserveForAppend(size_t count) {
+        if (size_ + count > Capacity()) {
+            Reserve(GrowthCapacity(size_ + count));
+        }
+    }
+
+    // Переносит элементы в буфер ровно на new_capacity (>= size_) элементов
+    void Reallocate(size_t new_capacity) {
+        assert(new_capacity >= size_);
+        Stats::RecordBufferChange(data_.Capacity(), new_capacity, size_);
+        if constexpr (RawMemory<T, Allocator>::CAN_REALLOCATE) {
+            data_.Reallocate(new_capacity);
+            return;
+        }
+
+        RawMemory<T, Allocator> new_data(new_capacity, data_.GetAllocator());
+        detail::UninitializedRelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+        // Разрушаем элементы в data_ (перенесённые побайтно разрушать не нужно)
+        detail::DestroyRelocatedN(data_.GetAddress(), size_);
+        // Избавляемся от старой сырой памяти, обменивая её на новую.
+        // При выходе из метода старая память будет возвращена в кучу
+        data_.Swap(new_data);
+    }
+
+    // Авто-сжатие после удаления элементов, если его поддерживает GrowthPolicy.
+    // Это только экономия памяти: если перевыделить не вышло, остаётся прежний буфер.
+    // Без noexcept-перемещения и копирования неудачный перенос испортил бы элементы, такие T не сжимаются
+    void ShrinkIfUnderused() noexcept {
+        if constexpr (HasShrinkCapacity<GrowthPolicy>::value
+                      && (std::is_nothrow_move_constructible_v<T> || std::is_copy_constructible_v<T>)) {
+            const size_t new_capacity = GrowthPolicy::ShrinkCapacity(data_.Capacity(), size_, sizeof(T));
+            if (new_capacity < data_.Capacity()) {
+                try {
+                    Reallocate(new_capacity);
+                } catch (...) {
+                }
+            }
+        }
+    }
+
+    // Вместимость нового буфера, когда для required элементов текущего не хватает
+    size_t GrowthCapacity(size_t required) const noexcept {
+        return GrowthPolicy::NextCapacity(data_.Capacity(), required, sizeof(T));
+    }
+
+    // Достраивает new_data вокруг уже сконструированных в ней count элементов [index, index + count):
+    // переносит туда элементы слева и справа от index и делает new_data своим буфером.
+    // Сырую память new_data при исключении освободит её деструктор,
+    // здесь разрушаем только уже сконструированные в ней элементы
+    void RelocateAroundGap(RawMemory<T, Allocator>& new_data, size_t index, size_t count) {
+        T* gap = new_data.GetAddress() + index;
+        try {
+            detail::UninitializedRelocateN(data_.GetAddress(), index, new_data.GetAddress());
+        } catch (...) {
+            detail::DestroyN(gap, count);
+            throw;
+        }
+
+        try {
+            detail::UninitializedRelocateN(data_.GetAddress() + index, size_ - index, gap + count);
+        } catch (...) {
+            detail::DestroyN(new_data.GetAddress(), index + count);
+            throw;
+        }
+
+        detail::DestroyRelocatedN(data_.GetAddress(), size_);
+        Stats::RecordBufferChange(data_.Capacity(), new_data.Capacity(), size_);
+        data_.Swap(new_data);
+        size_ += count;
+    }
+
+    // Уничтожает свои элементы и забирает буфер rhs
+    void StealFrom(Vector& rhs) noexcept {
+        std::destroy_n(data_.GetAddress(), size_);
+        data_.StealBuffer(rhs.data_);
+        size_ = std::exchange(rhs.size_, 0);
+    }
+
 private:
-    RawMemory<T> data_;
+    RawMemory<T, Allocator> data_;
     size_t size_ = 0;
 //    size_t capacity_ = 0;
 //    T*  data_ = nullptr;
 
 };
+
+// Vector — указатель на буфер, вместимость и размер: переносится побайтно, если это можно сделать с аллокатором
+template <typename T, typename Allocator, typename GrowthPolicy>
+struct IsTriviallyRelocatable<Vector<T, Allocator, GrowthPolicy>> : IsTriviallyRelocatable<Allocator> {};
+
+// Удаляет из v все элементы, для которых pred вернул true, и возвращает их количество.
+// Выжившие уплотняются за один проход, хвост разрушается одним Erase.
+// Мелкие тривиально копируемые элементы (до двух слов) копируются без ветвлений: каждый пишется на место out,
+// а out сдвигается, только если элемент выжил, так что непредсказуемый pred не сбивает предсказатель.
+// Крупным такая запись каждого элемента обходится дороже промаха: у них ищутся подряд идущие выжившие,
+// и каждый такой участок переезжает одним memmove
+template <typename T, typename Allocator, typename GrowthPolicy, typename Predicate>
+size_t EraseIf(Vector<T, Allocator, GrowthPolicy>& v, Predicate pred) {
+    constexpr size_t BRANCHLESS_MAX_SIZE = 2 * sizeof(uint64_t);
+    T* first = std::find_if(v.begin(), v.end(), pred);
+    T* out = first;
+    if (first != v.end()) {
+        if constexpr (std::is_trivially_copyable_v<T> && sizeof(T) <= BRANCHLESS_MAX_SIZE) {
+            for (T* in = first + 1; in != v.end(); ++in) {
+                const T value = *in;
+                *out = value;
+                out += pred(value) ? 0 : 1;
+            }
+        } else if constexpr (std::is_trivially_copyable_v<T>) {
+            for (T* in = first + 1; in != v.end();) {
+                T* run_end = std::find_if(in, v.end(), pred);
+                const size_t run = static_cast<size_t>(run_end - in);
+                std::memmove(static_cast<void*>(out), static_cast<const void*>(in), run * sizeof(T));
+                out += run;
+                in = run_end != v.end() ? run_end + 1 : run_end;
+            }
+        } else {
+            out = std::remove_if(first, v.end(), pred);
+        }
+    }
+    const size_t removed = static_cast<size_t>(v.end() - out);
+    v.Erase(out, v.end());
+    return removed;
+}
+
+// Непрерывный участок чужих элементов: указатель и длина, как std::span из C++20.
+// Действителен, пока владелец не перевыделит буфер
+template <typename T>
+class Span {
+public:
+    using value_type = std::remove_cv_t<T>;
+    using iterator = T*;
+
+    Span() = default;
+
+    Span(T* data, size_t size) noexcept
+        : data_(data)
+        , size_(size) {}
+
+    // Span<T> -> Span<const T>
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+    Span(Span<U> other) noexcept
+        : data_(other.Data())
+        , size_(other.Size()) {}
+
+    template <typename Allocator, typename GrowthPolicy>
+    Span(Vector<value_type, Allocator, GrowthPolicy>& v) noexcept
+        : data_(v.begin())
+        , size_(v.Size()) {}
+
+    template <typename Allocator, typename GrowthPolicy, typename U = T,
+              typename = std::enable_if_t<std::is_const_v<U>>>
+    Span(const Vector<value_type, Allocator, GrowthPolicy>& v) noexcept
+        : data_(v.begin())
+        , size_(v.Size()) {}
+
+    iterator begin() const noexcept {
+        return data_;
+    }
+    iterator end() const noexcept {
+        return data_ + size_;
+    }
+
+    T* Data() const noexcept {
+        return data_;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Vector, чей буфер всегда начинается с границы Alignment байт (по умолчанию кэш-линии)
+template <typename T, size_t Alignment = 64, typename GrowthPolicy = DoublingGrowth>
+using AlignedVector = Vector<T, AlignedAllocator<T, Alignment>, GrowthPolicy>;
+
+namespace pmr {
+
+// Vector, берущий память из std::pmr::memory_resource (арены, пулы и т.п.)
+template <typename T, typename GrowthPolicy = DoublingGrowth>
+using Vector = ::Vector<T, std::pmr::polymorphic_allocator<T>, GrowthPolicy>;
+
+}  // namespace pmr
+
 /*
 Если будете разрабатывать и отлаживать программу в IDE на вашем компьютере,
 рекомендуем использовать статический анализатор clang-tidy совместно с UB и Address санитайзерами.
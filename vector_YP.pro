@@ -1,5 +1,5 @@
 TEMPLATE = app
-CONFIG += console c++17
+CONFIG += console c++17 thread
 CONFIG -= app_bundle
 CONFIG -= qt
 
@@ -7,5 +7,19 @@ SOURCES += \
         main.cpp
 
 HEADERS += \
+    concurrent_vector.h \
+    cow_vector.h \
+    mapped_vector.h \
+    parallel_algorithms.h \
+    serialization.h \
+    simd_algorithms.h \
+    small_vector.h \
+    soa_vector.h \
+    stable_vector.h \
+    test_types.h \
+    thread_pool.h \
     tests.h \
     vector.h
+
+# Счётчики Vector::GetStats (реаллокации, переносы, сдвиги)
+# DEFINES += VECTOR_ENABLE_STATS
@@ -0,0 +1,20 @@
+TEMPLATE = app
+CONFIG += console c++17 thread
+CONFIG -= app_bundle
+CONFIG -= qt
+
+SOURCES += \
+        benchmark.cpp
+
+HEADERS += \
+    concurrent_vector.h \
+    cow_vector.h \
+    mapped_vector.h \
+    parallel_algorithms.h \
+    serialization.h \
+    simd_algorithms.h \
+    small_vector.h \
+    soa_vector.h \
+    test_types.h \
+    thread_pool.h \
+    vector.h